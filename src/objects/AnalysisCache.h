@@ -0,0 +1,263 @@
+#ifndef ANALYSISCACHE_H
+#define ANALYSISCACHE_H
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include "Position.h"
+
+/**
+ * Position-value cache backed by a memory-mapped file (POSIX only).
+ *
+ * The file starts with a versioned header followed by buckets of four
+ * 16-byte entries. Each entry is two 64-bit words written independently:
+ * the packed value and the key xor'ed with it. A reader accepts an entry
+ * only when the two words agree, so entries torn by a concurrent writer in
+ * another process are ignored rather than misread. Nothing is parsed at
+ * startup: lookups are plain loads from the mapping, and everything stored
+ * by earlier runs is immediately available.
+ *
+ * Keys are Position hashes, which are derived deterministically from the
+ * board and therefore stable across processes and restarts.
+ */
+class AnalysisCache
+{
+public:
+    static constexpr uint32_t Version = 2; // Bumped when stored scores change meaning, e.g. a new evaluation
+
+    enum Kind : uint8_t
+    {
+        Empty = 0,
+        SearchScore = 1, // Alpha-beta score with depth and bound
+        Proof = 2        // Solved result; score is 1 for a win, 0 otherwise
+    };
+
+    struct Value
+    {
+        int32_t score;
+        uint16_t depth;
+        uint8_t bound;
+        uint8_t kind;
+    };
+
+private:
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t entryCount;
+        uint64_t reserved[6];
+    };
+
+    struct Entry
+    {
+        std::atomic<uint64_t> check; // key ^ data
+        std::atomic<uint64_t> data;
+    };
+
+    static_assert(sizeof(Header) == 64, "Header must keep entries cache-line aligned");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "Entries must be lock-free to share across processes");
+
+    static constexpr size_t BucketSize = 4;
+
+    int fd = -1;
+    void *mapping = nullptr;
+    size_t mappingSize = 0;
+    Entry *entries = nullptr;
+    uint64_t bucketMask = 0;
+
+    static uint64_t pack(const Value &value)
+    {
+        return static_cast<uint64_t>(static_cast<uint32_t>(value.score)) |
+               static_cast<uint64_t>(value.depth) << 32 |
+               static_cast<uint64_t>(value.bound) << 48 |
+               static_cast<uint64_t>(value.kind) << 56;
+    }
+
+    static Value unpack(uint64_t data)
+    {
+        return {static_cast<int32_t>(static_cast<uint32_t>(data)),
+                static_cast<uint16_t>(data >> 32),
+                static_cast<uint8_t>(data >> 48),
+                static_cast<uint8_t>(data >> 56)};
+    }
+
+    static size_t fileSize(uint64_t entryCount)
+    {
+        return sizeof(Header) + entryCount * sizeof(Entry);
+    }
+
+    Entry *bucket(uint64_t key) const
+    {
+        return entries + (key & bucketMask) * BucketSize;
+    }
+
+    /**
+     * Caller holds the lock on fd. Writes an empty cache of the requested
+     * size to path.tmp and renames it over path, so a process that still
+     * maps the old file keeps valid pages instead of faulting on a
+     * truncated one. fd then refers to the new file.
+     */
+    void replaceFile(const std::string &path, uint64_t entryCount)
+    {
+        const std::string temporary = path + ".tmp";
+        const int tempFd = open(temporary.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (tempFd < 0)
+            throw std::runtime_error("Cannot create analysis cache " + temporary);
+
+        Header header{};
+        std::memcpy(header.magic, "GTAC", 4);
+        header.version = Version;
+        header.entryCount = entryCount;
+        if (ftruncate(tempFd, static_cast<off_t>(fileSize(entryCount))) != 0 ||
+            pwrite(tempFd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+            rename(temporary.c_str(), path.c_str()) != 0)
+        {
+            close(tempFd);
+            unlink(temporary.c_str());
+            throw std::runtime_error("Cannot create analysis cache " + path);
+        }
+        flock(fd, LOCK_UN);
+        close(fd);
+        fd = tempFd;
+    }
+
+public:
+    /**
+     * Open or create the cache at path. A new file gets roughly the given
+     * size; an existing file with a matching header keeps its own size.
+     * Files from another format version or of the wrong size are replaced
+     * by a new file; processes still using the old one are unaffected.
+     */
+    AnalysisCache(const std::string &path, size_t megabytes)
+    {
+        uint64_t buckets = 1;
+        const uint64_t wanted = std::max<uint64_t>(megabytes * 1024 * 1024 / (BucketSize * sizeof(Entry)), 1);
+        while (buckets * 2 <= wanted)
+            buckets *= 2;
+
+        // Serialize setup with other processes opening the same file. One of
+        // them may replace it while we wait for the lock; then open it again
+        struct stat info{};
+        for (;;)
+        {
+            fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+            if (fd < 0)
+                throw std::runtime_error("Cannot open analysis cache " + path);
+            flock(fd, LOCK_EX);
+            struct stat current{};
+            if (fstat(fd, &info) == 0 && stat(path.c_str(), &current) == 0 &&
+                info.st_dev == current.st_dev && info.st_ino == current.st_ino)
+                break;
+            flock(fd, LOCK_UN);
+            close(fd);
+        }
+
+        Header header{};
+        const bool readable = info.st_size >= static_cast<off_t>(sizeof(Header)) &&
+                              pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header));
+        const bool valid = readable && std::memcmp(header.magic, "GTAC", 4) == 0 &&
+                           header.version == Version && header.entryCount >= BucketSize &&
+                           (header.entryCount & (header.entryCount - 1)) == 0 &&
+                           static_cast<size_t>(info.st_size) == fileSize(header.entryCount);
+        if (!valid)
+        {
+            header.entryCount = buckets * BucketSize;
+            try
+            {
+                replaceFile(path, header.entryCount);
+            }
+            catch (...)
+            {
+                flock(fd, LOCK_UN);
+                close(fd);
+                throw;
+            }
+        }
+        flock(fd, LOCK_UN);
+
+        mappingSize = fileSize(header.entryCount);
+        mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            close(fd);
+            throw std::runtime_error("Cannot map analysis cache " + path);
+        }
+        entries = reinterpret_cast<Entry *>(static_cast<char *>(mapping) + sizeof(Header));
+        bucketMask = header.entryCount / BucketSize - 1;
+    }
+
+    ~AnalysisCache()
+    {
+        if (mapping && mapping != MAP_FAILED)
+            munmap(mapping, mappingSize);
+        if (fd >= 0)
+            close(fd);
+    }
+
+    AnalysisCache(const AnalysisCache &) = delete;
+    AnalysisCache &operator=(const AnalysisCache &) = delete;
+
+    size_t getEntryCount() const { return (bucketMask + 1) * BucketSize; }
+    size_t getMappedBytes() const { return mappingSize; }
+
+    // Key for a proof result, so proofs for either player can share the table
+    static uint64_t proofKey(uint64_t hash, int player)
+    {
+        return hash ^ mixHash(0x70726f6f66ULL + player);
+    }
+
+    bool probe(uint64_t key, Value &value) const
+    {
+        const Entry *slots = bucket(key);
+        for (size_t i = 0; i < BucketSize; ++i)
+        {
+            const uint64_t data = slots[i].data.load(std::memory_order_relaxed);
+            const uint64_t check = slots[i].check.load(std::memory_order_relaxed);
+            if ((check ^ data) == key && (data >> 56) != Empty)
+            {
+                value = unpack(data);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Overwrite the same key, else an empty slot, else the shallowest entry
+    void store(uint64_t key, const Value &value)
+    {
+        Entry *slots = bucket(key);
+        Entry *target = &slots[0];
+        uint16_t targetDepth = UINT16_MAX;
+        for (size_t i = 0; i < BucketSize; ++i)
+        {
+            const uint64_t data = slots[i].data.load(std::memory_order_relaxed);
+            const uint64_t check = slots[i].check.load(std::memory_order_relaxed);
+            const Value existing = unpack(data);
+            if ((check ^ data) == key || existing.kind == Empty)
+            {
+                target = &slots[i];
+                break;
+            }
+            if (existing.kind != Proof && existing.depth < targetDepth)
+            {
+                target = &slots[i];
+                targetDepth = existing.depth;
+            }
+        }
+
+        const uint64_t data = pack(value);
+        target->data.store(data, std::memory_order_relaxed);
+        target->check.store(key ^ data, std::memory_order_relaxed);
+    }
+};
+
+#endif // ANALYSISCACHE_H
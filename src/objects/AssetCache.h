@@ -0,0 +1,162 @@
+#ifndef ASSETCACHE_H
+#define ASSETCACHE_H
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Shared fonts and token textures, loaded off the render thread.
+ *
+ * The constructor starts reading the font and decoding the token PNGs on
+ * background threads. The render thread then only has to wrap the font
+ * bytes and upload the decoded pixels, which happens once per asset the
+ * first time it is requested (or all at once through finalize()).
+ */
+class AssetCache
+{
+private:
+    static constexpr const char *FontPath = "arial.ttf";
+    static constexpr const char *TokenPaths[2] = {"rtoken.png", "gtoken.png"};
+    static constexpr unsigned AtlasGutter = 2; // Transparent pixels between the atlas images
+
+    std::future<std::vector<char>> pendingFont;
+    std::future<sf::Image> pendingImages[2];
+
+    std::vector<char> fontData; // Must outlive font, which reads glyphs lazily
+    sf::Font font;
+    sf::Image tokenImages[2];
+    sf::Texture tokenTextures[2];
+    sf::Texture tokenAtlas; // Both token images side by side, AtlasGutter apart
+    bool fontReady = false;
+    bool imageReady[2] = {false, false};
+    bool textureReady[2] = {false, false};
+    bool atlasReady = false;
+
+    static std::vector<char> readFile(const std::string &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            throw std::runtime_error("Failed to open " + path);
+        }
+        return std::vector<char>(std::istreambuf_iterator<char>(file),
+                                 std::istreambuf_iterator<char>());
+    }
+
+    static sf::Image decodeImage(const std::string &path)
+    {
+        sf::Image image;
+        if (!image.loadFromFile(path))
+        {
+            std::cerr << "Failed to load texture: " << path << std::endl;
+        }
+        return image;
+    }
+
+public:
+    AssetCache()
+    {
+        pendingFont = std::async(std::launch::async, readFile, std::string(FontPath));
+        for (int player = 0; player < 2; ++player)
+        {
+            pendingImages[player] = std::async(std::launch::async, decodeImage,
+                                               std::string(TokenPaths[player]));
+        }
+    }
+
+    AssetCache(const AssetCache &) = delete;
+    AssetCache &operator=(const AssetCache &) = delete;
+
+    // Font shared by every screen; blocks until the file has been read
+    const sf::Font &getFont()
+    {
+        if (!fontReady)
+        {
+            fontData = pendingFont.get();
+            if (!font.openFromMemory(fontData.data(), fontData.size()))
+            {
+                throw std::runtime_error("Failed to load font!");
+            }
+            fontReady = true;
+        }
+        return font;
+    }
+
+    // Decoded token image; blocks until it has been read
+    const sf::Image &getTokenImage(int player)
+    {
+        if (!imageReady[player])
+        {
+            tokenImages[player] = pendingImages[player].get();
+            imageReady[player] = true;
+        }
+        return tokenImages[player];
+    }
+
+    // Token texture for the given player; must be called on the render thread
+    const sf::Texture &getTokenTexture(int player)
+    {
+        if (!textureReady[player])
+        {
+            if (!tokenTextures[player].loadFromImage(getTokenImage(player)))
+            {
+                std::cerr << "Failed to upload texture: " << TokenPaths[player] << std::endl;
+            }
+            textureReady[player] = true;
+        }
+        return tokenTextures[player];
+    }
+
+    /**
+     * One texture holding both token images, so every token of every board
+     * can be drawn in a single call. Player 1's image starts AtlasGutter
+     * pixels after player 0's, so smoothing at an image's edge blends with
+     * transparency rather than the other image; getTokenAtlasRect() gives
+     * each image's area.
+     */
+    const sf::Texture &getTokenAtlas()
+    {
+        if (!atlasReady)
+        {
+            const sf::Vector2u first = getTokenImage(0).getSize();
+            const sf::Vector2u second = getTokenImage(1).getSize();
+            sf::Image atlas({first.x + AtlasGutter + second.x, std::max({first.y, second.y, 1u})},
+                            sf::Color::Transparent);
+            if (!atlas.copy(getTokenImage(0), {0, 0}) || !atlas.copy(getTokenImage(1), {first.x + AtlasGutter, 0}))
+            {
+                std::cerr << "Failed to build token atlas" << std::endl;
+            }
+            if (!tokenAtlas.loadFromImage(atlas))
+            {
+                std::cerr << "Failed to upload token atlas" << std::endl;
+            }
+            tokenAtlas.setSmooth(true);
+            atlasReady = true;
+        }
+        return tokenAtlas;
+    }
+
+    sf::FloatRect getTokenAtlasRect(int player)
+    {
+        const sf::Vector2f size(getTokenImage(player).getSize());
+        const float left = player == 0 ? 0.0f : static_cast<float>(getTokenImage(0).getSize().x + AtlasGutter);
+        return {{left, 0.0f}, size};
+    }
+
+    // Wait for every pending asset so nothing is loaded mid-game
+    void finalize()
+    {
+        getFont();
+        getTokenTexture(0);
+        getTokenTexture(1);
+    }
+};
+
+#endif // ASSETCACHE_H
@@ -0,0 +1,263 @@
+#ifndef BATCHPLAYOUT_H
+#define BATCHPLAYOUT_H
+
+#include <cstdint>
+#include <stdexcept>
+#include "Position.h"
+
+// Outcomes of finished playouts
+struct PlayoutTotals
+{
+    uint64_t games = 0;
+    uint64_t wins[2] = {0, 0};
+    uint64_t blocked = 0;
+    uint64_t plies = 0; // Over finished games
+};
+
+/**
+ * Random playouts of many small-board games at once, for Monte Carlo
+ * analysis and data generation.
+ *
+ * Boards up to 8x8 fit in a 64-bit word per player (bit y * 8 + x). Each
+ * of Lanes games lives in structure-of-arrays slots, and step() moves
+ * every lane once in a single pass of branch-free loops: move generation
+ * is shifts and masks over the occupancy words, the side to move is an
+ * all-ones or all-zero mask that selects between the players' terms, and
+ * a finished game is counted and restarted by masked selects. The
+ * compiler turns the loop into vector code, so one instruction advances
+ * several games; nothing here uses intrinsics. It needs variable 64-bit
+ * shifts, i.e. AVX2 or wider, and -O3 (see the playout target in
+ * CMakeLists.txt); without them it still runs, one lane at a time.
+ *
+ * Moves are chosen uniformly among the side to move's movable tokens.
+ * The rules are Position's: a finished lane matches what makeMove() and
+ * isGameOver() give for the same moves, which the playout tool checks.
+ */
+template <size_t Lanes = 16>
+class BatchPlayout
+{
+    static_assert(Lanes > 0 && Lanes % 4 == 0, "Lanes must be a multiple of 4");
+
+public:
+    static constexpr size_t MaxBoardSize = 8;
+    static constexpr int MaxTokens = MaxBoardSize - 2;
+
+    enum Outcome : uint8_t
+    {
+        Playing,
+        Player0Won,
+        Player1Won,
+        Blocked // Neither side can move and nobody has every token home
+    };
+
+    using Totals = PlayoutTotals;
+
+private:
+    // Board geometry
+    size_t size = 0;
+    uint64_t inside = 0;
+    uint64_t notFirstColumn = 0;   // Cells a player 0 token can step onto
+    uint64_t notFirstColumns = 0;  // Cells a player 0 token can jump onto
+    uint64_t goal[2] = {0, 0};     // Far-edge cells every token of the player must reach
+
+    // Start of every game; a lane that finishes restarts from here
+    uint64_t start[2] = {0, 0};
+    uint64_t startSide = 0;
+
+    // Per-lane state; side is 0 for player 0 and all ones for player 1
+    alignas(64) uint64_t tokens[2][Lanes];
+    alignas(64) uint64_t side[Lanes];
+    alignas(64) uint64_t rng[Lanes];
+    alignas(64) uint64_t ply[Lanes];
+    alignas(64) uint64_t lastFrom[Lanes];
+    alignas(64) uint64_t lastTo[Lanes];
+    alignas(64) uint64_t outcome[Lanes];
+
+    // Per-lane tallies, summed by totals()
+    alignas(64) uint64_t wins[2][Lanes];
+    alignas(64) uint64_t blocked[Lanes];
+    alignas(64) uint64_t plies[Lanes];
+
+    // Popcount of at most 8 set bits in shifts and adds, which vectorize where popcnt does not
+    static uint64_t countBits(uint64_t bits)
+    {
+        bits = bits - ((bits >> 1) & 0x5555555555555555ULL);
+        bits = (bits & 0x3333333333333333ULL) + ((bits >> 2) & 0x3333333333333333ULL);
+        bits = (bits + (bits >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+        bits += bits >> 8;
+        bits += bits >> 16;
+        bits += bits >> 32;
+        return bits & 0x7f;
+    }
+
+    // Tokens of player 0 (moving +x) and player 1 (moving +y) that step, and that jump
+    void movable(uint64_t player0, uint64_t player1, uint64_t *steps, uint64_t *jumps) const
+    {
+        const uint64_t occupied = player0 | player1;
+        const uint64_t empty = inside & ~occupied;
+        steps[0] = player0 & ((empty & notFirstColumn) >> 1);
+        jumps[0] = player0 & ((occupied & notFirstColumn) >> 1) & ((empty & notFirstColumns) >> 2);
+        steps[1] = player1 & (empty >> 8);
+        jumps[1] = player1 & (occupied >> 8) & (empty >> 16);
+    }
+
+    void restart(size_t lane)
+    {
+        tokens[0][lane] = start[0];
+        tokens[1][lane] = start[1];
+        side[lane] = startSide;
+        ply[lane] = 0;
+        lastFrom[lane] = lastTo[lane] = 0;
+        outcome[lane] = Playing;
+    }
+
+public:
+    BatchPlayout() { reset(Position(3), 1); }
+
+    // Start every lane from pos, which must be a board of at most 8x8 with moves left
+    void reset(const Position &pos, uint64_t seed)
+    {
+        const BoardGrid &grid = pos.getGrid();
+        size = grid.getWidth();
+        if (size > MaxBoardSize)
+            throw std::runtime_error("Batch playouts need a board of at most 8x8");
+        if (pos.isGameOver())
+            throw std::runtime_error("Batch playouts need a position with moves left");
+
+        inside = notFirstColumn = notFirstColumns = 0;
+        goal[0] = goal[1] = start[0] = start[1] = 0;
+        for (size_t y = 0; y < size; ++y)
+        {
+            for (size_t x = 0; x < size; ++x)
+            {
+                const uint64_t bit = 1ULL << (y * MaxBoardSize + x);
+                inside |= bit;
+                notFirstColumn |= x >= 1 ? bit : 0;
+                notFirstColumns |= x >= 2 ? bit : 0;
+                if (x == size - 1 && y >= 1 && y + 1 < size)
+                    goal[0] |= bit;
+                if (y == size - 1 && x >= 1 && x + 1 < size)
+                    goal[1] |= bit;
+
+                const size_t idx = grid.index(x, y);
+                if (grid.isOccupied(idx))
+                    start[BoardGrid::cellPlayer(grid.at(idx))] |= bit;
+            }
+        }
+        startSide = pos.getSideToMove() == 1 ? ~0ULL : 0;
+
+        // splitmix64 seeds, so neighbouring lanes do not start correlated
+        uint64_t state = seed;
+        for (size_t lane = 0; lane < Lanes; ++lane)
+        {
+            state += 0x9e3779b97f4a7c15ULL;
+            rng[lane] = mixHash(state) | 1;
+            wins[0][lane] = wins[1][lane] = blocked[lane] = plies[lane] = 0;
+            restart(lane);
+        }
+    }
+
+    /**
+     * One random move in every lane. A lane whose game ends records the
+     * outcome, which getOutcome() reports until the next step, and starts
+     * over from the start position.
+     */
+    void step()
+    {
+        for (size_t lane = 0; lane < Lanes; ++lane)
+        {
+            const uint64_t player0 = tokens[0][lane];
+            const uint64_t player1 = tokens[1][lane];
+            const uint64_t mover = side[lane];
+
+            uint64_t steps[2], jumps[2];
+            movable(player0, player1, steps, jumps);
+            const uint64_t jumping = (jumps[0] & ~mover) | (jumps[1] & mover);
+            uint64_t candidates = ((steps[0] | jumps[0]) & ~mover) | ((steps[1] | jumps[1]) & mover);
+
+            // xorshift64, then pick the pick-th lowest candidate without a branch per token
+            uint64_t random = rng[lane];
+            random ^= random << 13;
+            random ^= random >> 7;
+            random ^= random << 17;
+            rng[lane] = random;
+            const uint64_t pick = (static_cast<uint64_t>(static_cast<uint32_t>(random >> 32)) *
+                                   static_cast<uint32_t>(countBits(candidates))) >> 32;
+            for (uint64_t skip = 0; skip < MaxTokens; ++skip)
+                candidates &= candidates - (skip < pick);
+            const uint64_t from = candidates & (0 - candidates);
+
+            // Forward is one bit for player 0 and one row for player 1; a jump goes twice as far
+            const uint64_t forward = (mover & 7) + 1;
+            const uint64_t distance = forward << ((from & jumping) != 0);
+            const uint64_t to = from << distance;
+            const uint64_t moved0 = player0 ^ ((from | to) & ~mover);
+            const uint64_t moved1 = player1 ^ ((from | to) & mover);
+
+            // Position::makeMove: the turn passes unless the mover won or the opponent is stuck
+            movable(moved0, moved1, steps, jumps);
+            const uint64_t own = (moved0 & ~mover) | (moved1 & mover);
+            const uint64_t target = (goal[0] & ~mover) | (goal[1] & mover);
+            const uint64_t ownMoves = ((steps[0] | jumps[0]) & ~mover) | ((steps[1] | jumps[1]) & mover);
+            const uint64_t opponentMoves = ((steps[0] | jumps[0]) & mover) | ((steps[1] | jumps[1]) & ~mover);
+            const uint64_t won = 0 - static_cast<uint64_t>((own & target) == target);
+            const uint64_t passes = ~won & (0 - static_cast<uint64_t>(opponentMoves != 0));
+            const uint64_t stuck = ~won & ~passes & (0 - static_cast<uint64_t>(ownMoves == 0));
+            const uint64_t over = won | stuck;
+
+            const uint64_t length = ply[lane] + 1;
+            wins[0][lane] += won & ~mover & 1;
+            wins[1][lane] += won & mover & 1;
+            blocked[lane] += stuck & 1;
+            plies[lane] += length & over;
+            outcome[lane] = (won & ((mover & 1) + 1)) | (stuck & Blocked);
+
+            lastFrom[lane] = from;
+            lastTo[lane] = to;
+            tokens[0][lane] = (moved0 & ~over) | (start[0] & over);
+            tokens[1][lane] = (moved1 & ~over) | (start[1] & over);
+            side[lane] = ((mover ^ passes) & ~over) | (startSide & over);
+            ply[lane] = length & ~over;
+        }
+    }
+
+    // Step until at least games games have finished across the lanes; returns the totals so far
+    Totals run(uint64_t games)
+    {
+        Totals done = totals();
+        while (done.games < games)
+        {
+            // Every lane finishes at most one game per step
+            for (uint64_t steps = (games - done.games + Lanes - 1) / Lanes; steps > 0; --steps)
+                step();
+            done = totals();
+        }
+        return done;
+    }
+
+    Totals totals() const
+    {
+        Totals sum;
+        for (size_t lane = 0; lane < Lanes; ++lane)
+        {
+            sum.wins[0] += wins[0][lane];
+            sum.wins[1] += wins[1][lane];
+            sum.blocked += blocked[lane];
+            sum.plies += plies[lane];
+        }
+        sum.games = sum.wins[0] + sum.wins[1] + sum.blocked;
+        return sum;
+    }
+
+    static constexpr size_t lanes() { return Lanes; }
+    size_t getSize() const { return size; }
+
+    // Lane state after the last step: occupancy as bit y * 8 + x, and the move it made
+    uint64_t getTokens(size_t lane, int player) const { return tokens[player][lane]; }
+    int getSideToMove(size_t lane) const { return static_cast<int>(side[lane] & 1); }
+    Outcome getOutcome(size_t lane) const { return static_cast<Outcome>(outcome[lane]); }
+    uint64_t getLastFrom(size_t lane) const { return lastFrom[lane]; }
+    uint64_t getLastTo(size_t lane) const { return lastTo[lane]; }
+};
+
+#endif // BATCHPLAYOUT_H
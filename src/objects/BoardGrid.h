@@ -0,0 +1,193 @@
+#ifndef BOARDGRID_H
+#define BOARDGRID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Outcome of validating or applying a move
+enum class MoveStatus : uint8_t
+{
+    Ok,
+    OutOfBounds,
+    NoToken,
+    Immovable,
+    CannotJump,
+    IllegalMove, // Target is neither the square in front nor the landing square; applyMoves() also rejects moves out of turn
+    GameOver     // A move after a player brought every token home; only from GameBoard::applyMoves()
+};
+
+inline const char *moveStatusMessage(MoveStatus status) noexcept
+{
+    switch (status)
+    {
+    case MoveStatus::Ok:
+        return "Ok";
+    case MoveStatus::OutOfBounds:
+        return "Move coordinates out of bounds";
+    case MoveStatus::NoToken:
+        return "No token at source position";
+    case MoveStatus::Immovable:
+        return "Token is immovable";
+    case MoveStatus::CannotJump:
+        return "Can't jump";
+    case MoveStatus::IllegalMove:
+        return "Not a forward move of the player to move";
+    case MoveStatus::GameOver:
+        return "Game is already over";
+    }
+    return "Unknown move status";
+}
+
+// Move validation result; x and y hold the landing square when ok()
+struct MoveResult
+{
+    MoveStatus status;
+    int x;
+    int y;
+
+    bool ok() const noexcept { return status == MoveStatus::Ok; }
+};
+
+/**
+ * Flat occupancy grid for a game board.
+ *
+ * Cells live in one contiguous row-major buffer, one byte each, surrounded
+ * by a one-cell Wall border. Stepping off the board in any direction lands
+ * on a Wall, so move generation never needs a bounds check.
+ */
+class BoardGrid
+{
+public:
+    enum Cell : uint8_t
+    {
+        Empty = 0,
+        Player0 = 1,
+        Player1 = 2,
+        Wall = 3
+    };
+
+    // Returned by landingIndex() when a token has no legal move. Index 0 is
+    // the top-left sentinel, so it can never be a real landing square.
+    static constexpr size_t NoMove = 0;
+
+private:
+    size_t Width;
+    size_t Height;
+    size_t Stride;
+    std::vector<uint8_t> cells;
+
+public:
+    BoardGrid(size_t width, size_t height)
+        : Width(width), Height(height), Stride(width + 2),
+          cells((width + 2) * (height + 2), Wall)
+    {
+        for (size_t y = 0; y < Height; ++y)
+        {
+            for (size_t x = 0; x < Width; ++x)
+            {
+                cells[index(x, y)] = Empty;
+            }
+        }
+    }
+
+    size_t getWidth() const { return Width; }
+    size_t getHeight() const { return Height; }
+    size_t getStride() const { return Stride; }
+
+    // Total number of cells including the sentinel border
+    size_t size() const { return cells.size(); }
+
+    // Raw cell buffer, useful for hashing or copying a position
+    const uint8_t *data() const { return cells.data(); }
+
+    // Index of the first and one-past-last cell of the playable area
+    size_t firstIndex() const { return index(0, 0); }
+    size_t endIndex() const { return index(0, Height); }
+
+    bool isValidPosition(int x, int y) const
+    {
+        return x >= 0 && y >= 0 &&
+               static_cast<size_t>(x) < Width &&
+               static_cast<size_t>(y) < Height;
+    }
+
+    size_t index(size_t x, size_t y) const
+    {
+        return (y + 1) * Stride + (x + 1);
+    }
+
+    int column(size_t idx) const
+    {
+        return static_cast<int>(idx % Stride) - 1;
+    }
+
+    int row(size_t idx) const
+    {
+        return static_cast<int>(idx / Stride) - 1;
+    }
+
+    uint8_t at(size_t idx) const { return cells[idx]; }
+    uint8_t at(size_t x, size_t y) const { return cells[index(x, y)]; }
+
+    void set(size_t idx, Cell cell) { cells[idx] = cell; }
+
+    bool isEmpty(size_t idx) const { return cells[idx] == Empty; }
+
+    // True for cells holding a token of either player
+    bool isOccupied(size_t idx) const
+    {
+        return cells[idx] == Player0 || cells[idx] == Player1;
+    }
+
+    static Cell playerCell(int player)
+    {
+        return player == 0 ? Player0 : Player1;
+    }
+
+    static int cellPlayer(uint8_t cell)
+    {
+        return cell == Player0 ? 0 : 1;
+    }
+
+    // Player 0 moves right (+1), player 1 moves down (+Stride)
+    size_t forwardOffset(int player) const
+    {
+        return player == 0 ? 1 : Stride;
+    }
+
+    /**
+     * Square the token at idx would land on, or NoMove if it is blocked.
+     * A token steps forward onto an empty cell, or jumps a single token
+     * when the cell behind it is empty.
+     */
+    size_t landingIndex(size_t idx) const
+    {
+        const size_t step = forwardOffset(cellPlayer(cells[idx]));
+        const size_t next = idx + step;
+        if (cells[next] == Empty)
+            return next;
+        if (cells[next] == Wall)
+            return NoMove;
+
+        const size_t jump = next + step;
+        return cells[jump] == Empty ? jump : NoMove;
+    }
+
+    bool canMove(size_t idx) const
+    {
+        return landingIndex(idx) != NoMove;
+    }
+
+    // True for cells on the outer ring of the playable area
+    bool isEdge(size_t idx) const
+    {
+        const int x = column(idx);
+        const int y = row(idx);
+        return x == 0 || y == 0 ||
+               static_cast<size_t>(x) == Width - 1 ||
+               static_cast<size_t>(y) == Height - 1;
+    }
+};
+
+#endif // BOARDGRID_H
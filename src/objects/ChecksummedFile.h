@@ -0,0 +1,68 @@
+#ifndef CHECKSUMMEDFILE_H
+#define CHECKSUMMEDFILE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include "Position.h"
+
+/**
+ * Whole-file I/O for the small binary formats (GameSnapshot, GameRecord):
+ * an FNV-1a trailer of all preceding bytes (8 bytes, little endian), a
+ * write that goes to a temporary file renamed over the target so a crash
+ * never leaves half a file, and a read of the whole file at once.
+ */
+struct ChecksummedFile
+{
+    static constexpr size_t ChecksumSize = 8;
+
+    static void appendChecksum(std::string &bytes)
+    {
+        const uint64_t hash = fnv1a(reinterpret_cast<const uint8_t *>(bytes.data()), bytes.size());
+        for (size_t i = 0; i < ChecksumSize; ++i)
+            bytes += static_cast<char>(hash >> (8 * i));
+    }
+
+    // Length of bytes before the trailer; throws "<what> checksum mismatch" if it does not match
+    static size_t verifyChecksum(const std::string &bytes, const std::string &what)
+    {
+        if (bytes.size() < ChecksumSize)
+            throw std::runtime_error(what + " is truncated");
+        const uint8_t *data = reinterpret_cast<const uint8_t *>(bytes.data());
+        const size_t body = bytes.size() - ChecksumSize;
+        uint64_t stored = 0;
+        for (size_t i = 0; i < ChecksumSize; ++i)
+            stored |= static_cast<uint64_t>(data[body + i]) << (8 * i);
+        if (stored != fnv1a(data, body))
+            throw std::runtime_error(what + " checksum mismatch");
+        return body;
+    }
+
+    static void write(const std::string &path, const std::string &bytes)
+    {
+        const std::string temporary = path + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            if (!out || !out.write(bytes.data(), static_cast<std::streamsize>(bytes.size())) || !out.flush())
+                throw std::runtime_error("Failed to write " + temporary);
+        }
+        if (std::rename(temporary.c_str(), path.c_str()) != 0)
+            throw std::runtime_error("Failed to replace " + path);
+    }
+
+    static std::string read(const std::string &path)
+    {
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in)
+            throw std::runtime_error("Failed to open " + path);
+        std::string bytes(static_cast<size_t>(in.tellg()), '\0');
+        in.seekg(0);
+        if (!in.read(&bytes[0], static_cast<std::streamsize>(bytes.size())))
+            throw std::runtime_error("Failed to read " + path);
+        return bytes;
+    }
+};
+
+#endif // CHECKSUMMEDFILE_H
@@ -0,0 +1,438 @@
+#ifndef DISTRIBUTEDSOLVER_H
+#define DISTRIBUTEDSOLVER_H
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "LineSocket.h"
+#include "ProofSolver.h"
+
+/**
+ * Distributed proof of a start position across worker processes.
+ *
+ * The coordinator expands the game tree breadth-first until it has enough
+ * leaves, then hands each leaf to a worker as a work unit. Workers prove
+ * or disprove the unit with ProofSolver and report back. Results are
+ * propagated up the split tree as an AND/OR tree, and units whose outcome
+ * no longer matters are skipped or cancelled.
+ *
+ * Protocol, one text line per message:
+ *   worker -> coordinator   ready
+ *                           result <unit> win|nowin|unknown <nodes>
+ *   coordinator -> worker   work <unit> <size> <player> [moves...]
+ *                           cancel <unit>
+ *                           wait | done
+ *
+ * An idle worker gets a unit that is already running elsewhere when the
+ * queue is empty, so a slow unit is picked up by whoever finishes first.
+ * Units held by a worker that disconnects go back on the queue.
+ */
+class SearchCoordinator
+{
+public:
+    struct Report
+    {
+        ProofSolver::Result result = ProofSolver::Result::Unknown;
+        size_t units = 0;
+        size_t reissued = 0;
+        uint64_t workerNodes = 0;
+        double seconds = 0;
+    };
+
+private:
+    enum class Status
+    {
+        Open,
+        Win,  // The root player forces a win from here
+        NoWin
+    };
+
+    struct Node
+    {
+        int parent;
+        std::vector<int> children;
+        std::vector<std::string> moves; // Moves from the start position
+        bool orNode;                    // Root player to move
+        Status status = Status::Open;
+        int assignees = 0; // Workers currently running this unit
+    };
+
+    struct Client
+    {
+        std::unique_ptr<LineSocket> socket;
+        int unit = -1;
+        bool waiting = false;
+    };
+
+    size_t boardSize;
+    size_t targetUnits;
+    int rootPlayer;
+    std::vector<Node> nodes;
+    std::deque<int> queue;
+    std::map<int, Client> clients; // Keyed by file descriptor
+    Report report;
+
+    bool isSettled(int node) const
+    {
+        for (int current = node; current >= 0; current = nodes[current].parent)
+        {
+            if (nodes[current].status != Status::Open)
+                return true;
+        }
+        return false;
+    }
+
+    // Re-derive a node's status from its children and push changes upwards
+    void propagate(int node)
+    {
+        for (int current = node; current >= 0; current = nodes[current].parent)
+        {
+            Node &entry = nodes[current];
+            if (entry.status != Status::Open && current != node)
+                return;
+
+            if (!entry.children.empty())
+            {
+                bool anyWin = false, allWin = true, anyNoWin = false, allNoWin = true;
+                for (int child : entry.children)
+                {
+                    const Status status = nodes[child].status;
+                    anyWin |= status == Status::Win;
+                    anyNoWin |= status == Status::NoWin;
+                    allWin &= status == Status::Win;
+                    allNoWin &= status == Status::NoWin;
+                }
+
+                Status status = Status::Open;
+                if (entry.orNode ? anyWin : allWin)
+                    status = Status::Win;
+                else if (entry.orNode ? allNoWin : anyNoWin)
+                    status = Status::NoWin;
+
+                if (status == Status::Open)
+                    return;
+                entry.status = status;
+            }
+        }
+    }
+
+    void buildTree()
+    {
+        const Position start(boardSize);
+        rootPlayer = start.getSideToMove();
+        nodes.push_back({-1, {}, {}, true});
+
+        // Breadth-first split until there are enough open leaves
+        std::deque<int> frontier{0};
+        while (!frontier.empty() && frontier.size() < targetUnits)
+        {
+            const int current = frontier.front();
+            frontier.pop_front();
+            if (isSettled(current))
+                continue;
+
+            Position pos(boardSize);
+            for (const std::string &text : nodes[current].moves)
+            {
+                Move move;
+                pos.parseMove(text, move);
+                pos.makeMove(move);
+            }
+
+            Move moves[Position::MaxMoves];
+            const int count = pos.generateMoves(moves);
+            for (int i = 0; i < count; ++i)
+            {
+                const Position::Undo undo = pos.makeMove(moves[i]);
+                Node child{current, {}, nodes[current].moves, pos.getSideToMove() == rootPlayer};
+                child.moves.push_back(pos.moveToString(moves[i]));
+                if (pos.isGameOver())
+                    child.status = pos.winner() == rootPlayer ? Status::Win : Status::NoWin;
+                pos.unmakeMove(undo);
+
+                const int index = static_cast<int>(nodes.size());
+                nodes[current].children.push_back(index);
+                nodes.push_back(std::move(child));
+                if (nodes[index].status == Status::Open)
+                    frontier.push_back(index);
+                else
+                    propagate(index);
+            }
+        }
+
+        queue.assign(frontier.begin(), frontier.end());
+        report.units = queue.size();
+    }
+
+    std::string workMessage(int unit) const
+    {
+        std::string message = "work " + std::to_string(unit) + " " +
+                              std::to_string(boardSize) + " " + std::to_string(rootPlayer);
+        for (const std::string &move : nodes[unit].moves)
+            message += " " + move;
+        return message;
+    }
+
+    // Pick the next unit: queued work first, otherwise steal a running one
+    int nextUnit()
+    {
+        while (!queue.empty())
+        {
+            const int unit = queue.front();
+            queue.pop_front();
+            if (!isSettled(unit))
+                return unit;
+        }
+
+        int best = -1;
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            const Node &node = nodes[i];
+            if (node.assignees > 0 && !isSettled(static_cast<int>(i)) &&
+                (best < 0 || node.assignees < nodes[best].assignees))
+                best = static_cast<int>(i);
+        }
+        return best;
+    }
+
+    void giveUnit(Client &client, int unit)
+    {
+        client.waiting = false;
+        client.unit = unit;
+        ++nodes[unit].assignees;
+        client.socket->sendLine(workMessage(unit));
+    }
+
+    void assign(Client &client)
+    {
+        const int unit = nextUnit();
+        if (unit < 0)
+        {
+            client.waiting = true;
+            client.socket->sendLine("wait");
+            return;
+        }
+        giveUnit(client, unit);
+    }
+
+    void release(Client &client)
+    {
+        if (client.unit < 0)
+            return;
+        const int unit = client.unit;
+        client.unit = -1;
+        if (--nodes[unit].assignees == 0 && !isSettled(unit))
+        {
+            queue.push_front(unit);
+            ++report.reissued;
+        }
+    }
+
+    // Cancel every running unit whose result is no longer needed
+    void cancelSettled()
+    {
+        for (auto &[fd, client] : clients)
+        {
+            if (client.unit >= 0 && isSettled(client.unit))
+                client.socket->sendLine("cancel " + std::to_string(client.unit));
+        }
+    }
+
+    void handleLine(Client &client, const std::string &line)
+    {
+        std::istringstream in(line);
+        std::string command;
+        in >> command;
+
+        if (command == "result")
+        {
+            int unit;
+            std::string outcome;
+            uint64_t workerNodes = 0;
+            in >> unit >> outcome >> workerNodes;
+            report.workerNodes += workerNodes;
+
+            if (client.unit == unit)
+            {
+                --nodes[unit].assignees;
+                client.unit = -1;
+            }
+            if (!isSettled(unit) && outcome != "unknown")
+            {
+                nodes[unit].status = outcome == "win" ? Status::Win : Status::NoWin;
+                propagate(unit);
+                cancelSettled();
+                std::cout << "unit " << unit << " " << outcome << " (" << workerNodes << " nodes)" << std::endl;
+            }
+        }
+
+        if (command == "ready" || command == "result")
+            assign(client);
+    }
+
+    void wakeWaiting()
+    {
+        for (auto &[fd, client] : clients)
+        {
+            if (!client.waiting)
+                continue;
+            const int unit = nextUnit();
+            if (unit < 0)
+                return;
+            giveUnit(client, unit);
+        }
+    }
+
+public:
+    SearchCoordinator(size_t size, size_t units)
+        : boardSize(size), targetUnits(units), rootPlayer(0) {}
+
+    // Serve workers on address:port until the root is settled
+    Report run(uint16_t port, const std::string &address = "127.0.0.1")
+    {
+        const auto startTime = std::chrono::steady_clock::now();
+        buildTree();
+        std::cout << "Split start position into " << report.units << " units" << std::endl;
+
+        const int listener = LineSocket::listenOn(port, address);
+        while (nodes[0].status == Status::Open)
+        {
+            std::vector<pollfd> fds{{listener, POLLIN, 0}};
+            for (const auto &[fd, client] : clients)
+                fds.push_back({fd, POLLIN, 0});
+            if (poll(fds.data(), fds.size(), 1000) < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                std::cout << "poll failed: " << std::strerror(errno) << std::endl;
+                break;
+            }
+
+            if (fds[0].revents & POLLIN)
+            {
+                const int fd = accept(listener, nullptr, nullptr);
+                if (fd >= 0)
+                    clients[fd].socket = std::make_unique<LineSocket>(fd);
+            }
+
+            for (size_t i = 1; i < fds.size(); ++i)
+            {
+                if (!fds[i].revents)
+                    continue;
+
+                Client &client = clients[fds[i].fd];
+                if (!client.socket->receive())
+                {
+                    std::cout << "worker on fd " << fds[i].fd << " disconnected" << std::endl;
+                    release(client);
+                    clients.erase(fds[i].fd);
+                    wakeWaiting();
+                    continue;
+                }
+
+                std::string line;
+                while (client.socket->nextLine(line))
+                    handleLine(client, line);
+            }
+            wakeWaiting();
+        }
+
+        for (auto &[fd, client] : clients)
+            client.socket->sendLine("done");
+        clients.clear();
+        close(listener);
+
+        // A root left open means the loop gave up, not that the position was disproved
+        report.result = nodes[0].status == Status::Win     ? ProofSolver::Result::Win
+                        : nodes[0].status == Status::NoWin ? ProofSolver::Result::NoWin
+                                                           : ProofSolver::Result::Unknown;
+        report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        return report;
+    }
+};
+
+// Worker side: proves the units handed out by a SearchCoordinator
+class SearchWorker
+{
+private:
+    ProofSolver solver;
+
+public:
+    explicit SearchWorker(size_t tableMegabytes) : solver(tableMegabytes) {}
+
+    // Serve units until the coordinator says done; returns units solved
+    size_t run(const std::string &host, uint16_t port)
+    {
+        LineSocket socket = LineSocket::connectTo(host, port);
+        socket.sendLine("ready");
+
+        size_t solved = 0;
+        std::string line;
+        while (socket.readLine(line))
+        {
+            std::istringstream in(line);
+            std::string command;
+            in >> command;
+
+            if (command == "done")
+                break;
+            if (command == "wait" || command == "cancel")
+                continue;
+            if (command != "work")
+                continue;
+
+            int unit, player;
+            size_t size;
+            in >> unit >> size >> player;
+
+            Position pos(size);
+            std::string text;
+            while (in >> text)
+            {
+                Move move;
+                if (!pos.parseMove(text, move))
+                    break;
+                pos.makeMove(move);
+            }
+
+            // Check for cancellation between progress reports
+            const std::string cancelLine = "cancel " + std::to_string(unit);
+            solver.setProgressCallback([&](const ProofSolver::Progress &)
+                                       {
+                while (socket.isReadable(0))
+                {
+                    if (!socket.receive())
+                    {
+                        solver.stop();
+                        return;
+                    }
+                    std::string pending;
+                    while (socket.nextLine(pending))
+                    {
+                        if (pending == cancelLine || pending == "done")
+                            solver.stop();
+                    }
+                } },
+                                       1 << 16);
+
+            const ProofSolver::Result result = solver.solve(pos, player);
+            const char *outcome = result == ProofSolver::Result::Win     ? "win"
+                                  : result == ProofSolver::Result::NoWin ? "nowin"
+                                                                         : "unknown";
+            if (!socket.sendLine("result " + std::to_string(unit) + " " + outcome + " " +
+                                 std::to_string(solver.getNodes())))
+                break;
+            ++solved;
+        }
+        return solved;
+    }
+};
+
+#endif // DISTRIBUTEDSOLVER_H
@@ -0,0 +1,251 @@
+#ifndef EVALTUNER_H
+#define EVALTUNER_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "Evaluator.h"
+#include "Search.h"
+
+/**
+ * Tunes the Evaluator weights by self-play and linear least squares.
+ *
+ * Each round plays games on worker threads with the current weights and
+ * fits new weights so that the evaluation of every position visited
+ * predicts the game's outcome for the side to move (+1 win, -1 loss, 0
+ * stall). Threads only accumulate the normal equations F'F and F'y, so a
+ * round needs constant memory however many positions it sees. The fitted
+ * weights are scaled so that a certain win evaluates to about Scale.
+ */
+class EvalTuner
+{
+public:
+    static constexpr double Scale = 1000.0;
+    static constexpr int N = Evaluator::FeatureCount;
+
+    struct Options
+    {
+        std::vector<size_t> boardSizes{6, 8, 10};
+        size_t gamesPerRound = 2000;
+        int rounds = 3;
+        int searchDepth = 3;
+        uint64_t searchNodes = 20000;
+        double randomMoveRate = 0.1;
+        int randomOpeningPlies = 4;
+        double ridge = 1e-3; // Keeps rarely seen features from blowing up
+        unsigned threads = 1;
+        uint64_t seed = 1;
+    };
+
+    struct Round
+    {
+        int round;
+        uint64_t positions;
+        double meanSquaredError; // Of the fitted weights on this round's positions
+        double seconds;
+        Evaluator::Weights weights;
+    };
+
+    using RoundCallback = std::function<void(const Round &)>;
+
+private:
+    // Normal equations of one thread, merged at the end of a round
+    struct Accumulator
+    {
+        double ftf[N][N] = {};
+        double fty[N] = {};
+        double yty = 0;
+        uint64_t count = 0;
+
+        void add(const Evaluator::Features &features, double target)
+        {
+            for (int i = 0; i < N; ++i)
+            {
+                for (int j = 0; j < N; ++j)
+                    ftf[i][j] += static_cast<double>(features[i]) * features[j];
+                fty[i] += features[i] * target;
+            }
+            yty += target * target;
+            ++count;
+        }
+
+        void merge(const Accumulator &other)
+        {
+            for (int i = 0; i < N; ++i)
+            {
+                for (int j = 0; j < N; ++j)
+                    ftf[i][j] += other.ftf[i][j];
+                fty[i] += other.fty[i];
+            }
+            yty += other.yty;
+            count += other.count;
+        }
+    };
+
+    Options options;
+
+    void playGame(size_t game, Search &search, Accumulator &accumulator) const
+    {
+        std::mt19937_64 rng(mixHash(options.seed ^ mixHash(game + 1)));
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        Position pos(options.boardSizes[game % options.boardSizes.size()]);
+
+        std::vector<Evaluator::Features> features;
+        std::vector<int> sides;
+        Move moves[Position::MaxMoves];
+        for (int ply = 0; !pos.isGameOver(); ++ply)
+        {
+            features.push_back(Evaluator::extract(pos));
+            sides.push_back(pos.getSideToMove());
+
+            const int count = pos.generateMoves(moves);
+            Move move = moves[rng() % count];
+            if (ply >= options.randomOpeningPlies && unit(rng) >= options.randomMoveRate)
+            {
+                Search::Limits limits;
+                limits.depth = options.searchDepth;
+                limits.nodes = options.searchNodes;
+                const Search::Info info = search.run(pos, limits);
+                if (info.hasMove)
+                    move = info.bestMove;
+            }
+            pos.makeMove(move);
+        }
+
+        const int winner = pos.winner();
+        for (size_t i = 0; i < features.size(); ++i)
+            accumulator.add(features[i], winner < 0 ? 0.0 : (winner == sides[i] ? 1.0 : -1.0));
+    }
+
+    // Solve (F'F + ridge I) w = F'y by Gaussian elimination with partial pivoting
+    std::array<double, N> solve(const Accumulator &total) const
+    {
+        double a[N][N + 1];
+        const double ridge = options.ridge * std::max<double>(total.count, 1);
+        for (int i = 0; i < N; ++i)
+        {
+            for (int j = 0; j < N; ++j)
+                a[i][j] = total.ftf[i][j] + (i == j ? ridge : 0.0);
+            a[i][N] = total.fty[i];
+        }
+
+        for (int col = 0; col < N; ++col)
+        {
+            int pivot = col;
+            for (int row = col + 1; row < N; ++row)
+            {
+                if (std::abs(a[row][col]) > std::abs(a[pivot][col]))
+                    pivot = row;
+            }
+            if (std::abs(a[pivot][col]) < 1e-12)
+                throw std::runtime_error("Tuning data does not determine every weight");
+            std::swap(a[col], a[pivot]);
+
+            for (int row = 0; row < N; ++row)
+            {
+                if (row == col)
+                    continue;
+                const double factor = a[row][col] / a[col][col];
+                for (int k = col; k <= N; ++k)
+                    a[row][k] -= factor * a[col][k];
+            }
+        }
+
+        std::array<double, N> w;
+        for (int i = 0; i < N; ++i)
+            w[i] = a[i][N] / a[i][i];
+        return w;
+    }
+
+    static double meanSquaredError(const Accumulator &total, const std::array<double, N> &w)
+    {
+        // |Fw - y|^2 = w'F'Fw - 2w'F'y + y'y
+        double error = total.yty;
+        for (int i = 0; i < N; ++i)
+        {
+            error -= 2 * w[i] * total.fty[i];
+            for (int j = 0; j < N; ++j)
+                error += w[i] * total.ftf[i][j] * w[j];
+        }
+        return error / std::max<double>(total.count, 1);
+    }
+
+public:
+    explicit EvalTuner(const Options &tunerOptions) : options(tunerOptions)
+    {
+        if (options.boardSizes.empty())
+            throw std::runtime_error("No board sizes to tune on");
+        for (size_t size : options.boardSizes)
+        {
+            if (size < 3 || size - 2 > Position::MaxMoves)
+                throw std::runtime_error("Board size must be between 3 and 51");
+        }
+        options.threads = std::max(options.threads, 1u);
+    }
+
+    Evaluator::Weights run(const Evaluator::Weights &initial, const RoundCallback &onRound = {})
+    {
+        Evaluator::Weights weights = initial;
+        for (int round = 0; round < options.rounds; ++round)
+        {
+            const auto startTime = std::chrono::steady_clock::now();
+            std::atomic<size_t> nextGame{0};
+            std::vector<Accumulator> accumulators(options.threads);
+            std::vector<std::thread> workers;
+            for (unsigned t = 0; t < options.threads; ++t)
+            {
+                workers.emplace_back([&, t]
+                                     {
+                    Search search(8);
+                    search.setEvalWeights(weights);
+                    for (size_t game = nextGame++; game < options.gamesPerRound; game = nextGame++)
+                        playGame(round * options.gamesPerRound + game, search, accumulators[t]); });
+            }
+            for (std::thread &worker : workers)
+                worker.join();
+
+            Accumulator total;
+            for (const Accumulator &accumulator : accumulators)
+                total.merge(accumulator);
+
+            const std::array<double, N> fitted = solve(total);
+            for (int i = 0; i < N; ++i)
+                weights[i] = static_cast<int>(std::lround(fitted[i] * Scale));
+
+            if (onRound)
+            {
+                onRound({round + 1, total.count, meanSquaredError(total, fitted),
+                         std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count(),
+                         weights});
+            }
+        }
+        return weights;
+    }
+
+    // Write weights as an EvalWeights.h that replaces the compiled-in table
+    static void writeHeader(std::ostream &out, const Evaluator::Weights &weights)
+    {
+        out << "// Generated by the tune tool; rerun it rather than editing by hand\n"
+            << "#ifndef EVALWEIGHTS_H\n"
+            << "#define EVALWEIGHTS_H\n\n"
+            << "#include <array>\n\n"
+            << "// Scored, Distance, Mobility, Blocked, Jumps, Obstruction, OnMove\n"
+            << "constexpr std::array<int, " << N << "> TunedEvalWeights = {";
+        for (int i = 0; i < N; ++i)
+            out << (i ? ", " : "") << weights[i];
+        out << "};\n\n"
+            << "#endif // EVALWEIGHTS_H\n";
+    }
+};
+
+#endif // EVALTUNER_H
@@ -0,0 +1,10 @@
+// Generated by the tune tool; rerun it rather than editing by hand
+#ifndef EVALWEIGHTS_H
+#define EVALWEIGHTS_H
+
+#include <array>
+
+// Scored, Distance, Mobility, Blocked, Jumps, Obstruction, OnMove
+constexpr std::array<int, 7> TunedEvalWeights = {-58, -286, 38, 20, 123, -55, 162};
+
+#endif // EVALWEIGHTS_H
@@ -0,0 +1,130 @@
+#ifndef EVALUATOR_H
+#define EVALUATOR_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include "EvalWeights.h"
+#include "Position.h"
+
+inline int popcount64(uint64_t bits)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(bits);
+#else
+    int count = 0;
+    for (; bits; bits &= bits - 1)
+        ++count;
+    return count;
+#endif
+}
+
+/**
+ * Static evaluation of a Position from the side to move's point of view.
+ *
+ * Every token stays in its own lane (a row for player 0, a column for
+ * player 1), so the board is summarised as one occupancy bitmask per row
+ * and per column. Each feature is then a shift and a popcount on the
+ * token's lane, and the score is a weighted sum of the differences between
+ * the side to move and the opponent. The weights come from the tune tool
+ * and are compiled in from EvalWeights.h.
+ */
+class Evaluator
+{
+public:
+    enum Feature
+    {
+        Scored,      // Tokens already home
+        Distance,    // Cells left to the far edge over all unscored tokens
+        Mobility,    // Tokens that can move, i.e. spare tempo
+        Blocked,     // Unscored tokens that cannot move
+        Jumps,       // Tokens with a jump available
+        Obstruction, // Tokens ahead of each token in its lane
+        OnMove,      // Constant 1: the bonus for having the move
+        FeatureCount
+    };
+
+    using Features = std::array<int, FeatureCount>;
+    using Weights = std::array<int, FeatureCount>;
+
+    static constexpr Weights DefaultWeights = TunedEvalWeights;
+    static constexpr size_t MaxBoardSize = 64; // Lanes are 64-bit masks
+
+    // Side to move's features minus the opponent's
+    static Features extract(const Position &pos)
+    {
+        const BoardGrid &grid = pos.getGrid();
+        const int size = static_cast<int>(grid.getWidth());
+        const int last = size - 1;
+
+        // Token coordinates, and occupancy along each lane: bit x of rows[y] and bit y of columns[x]
+        uint8_t along[2][Position::MaxMoves];
+        uint8_t lane[2][Position::MaxMoves];
+        uint64_t rows[MaxBoardSize];
+        uint64_t columns[MaxBoardSize];
+        std::fill(rows, rows + size, 0);
+        std::fill(columns, columns + size, 0);
+        for (int player = 0; player < 2; ++player)
+        {
+            const std::vector<uint16_t> &tokens = pos.getTokens(player);
+            for (size_t i = 0; i < tokens.size(); ++i)
+            {
+                const int x = grid.column(tokens[i]);
+                const int y = grid.row(tokens[i]);
+                rows[y] |= uint64_t(1) << x;
+                columns[x] |= uint64_t(1) << y;
+                along[player][i] = static_cast<uint8_t>(player == 0 ? x : y);
+                lane[player][i] = static_cast<uint8_t>(player == 0 ? y : x);
+            }
+        }
+
+        int counts[2][FeatureCount] = {};
+        for (int player = 0; player < 2; ++player)
+        {
+            int *count = counts[player];
+            const uint64_t *lanes = player == 0 ? rows : columns;
+            for (size_t i = 0; i < pos.getTokens(player).size(); ++i)
+            {
+                const int position = along[player][i];
+                if (position == last)
+                {
+                    ++count[Scored];
+                    continue;
+                }
+
+                const uint64_t ahead = lanes[lane[player][i]] >> (position + 1);
+                count[Distance] += last - position;
+                count[Obstruction] += popcount64(ahead);
+
+                // Step onto an empty cell, or jump one token onto an empty cell inside the board
+                if (!(ahead & 1))
+                    ++count[Mobility];
+                else if (position + 2 <= last && !(ahead & 2))
+                {
+                    ++count[Mobility];
+                    ++count[Jumps];
+                }
+                else
+                    ++count[Blocked];
+            }
+        }
+
+        const int side = pos.getSideToMove();
+        Features features;
+        for (int i = 0; i < FeatureCount; ++i)
+            features[i] = counts[side][i] - counts[1 - side][i];
+        features[OnMove] = 1;
+        return features;
+    }
+
+    static int evaluate(const Position &pos, const Weights &weights = DefaultWeights)
+    {
+        const Features features = extract(pos);
+        int score = 0;
+        for (int i = 0; i < FeatureCount; ++i)
+            score += weights[i] * features[i];
+        return score;
+    }
+};
+
+#endif // EVALUATOR_H
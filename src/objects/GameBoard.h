@@ -2,26 +2,32 @@
 #define GAMEBOARD_H
 
 #include <SFML/Graphics.hpp>
+#include <algorithm>
 #include <vector>
 #include <iostream>
 #include <stdexcept>
 #include <utility>
 #include "Token.h"
+#include "BoardGrid.h"
+#include "Position.h"
 
 class GameBoard
 {
 private:
     size_t Width;
     size_t Height;
-    std::vector<std::vector<Token *>> board;
+    BoardGrid grid;              // Occupancy used by all move logic
+    std::vector<Token *> tokens; // Token lookup, indexed like grid
+    std::vector<Token *> placed; // Every token on the board
+    std::vector<Token *> active; // Tokens that have not reached the end; swap-removed on retirement
+    int movableCount[2] = {0, 0}; // Movable tokens per player, kept by updateTokenMoveStatus()
     sf::Color borderColor = sf::Color::Black;
     unsigned borderThickness = 2;
+    mutable sf::VertexArray previewQuads[2]; // drawPosition() tokens per player, kept to reuse their storage
 
     bool isValidPosition(int x, int y) const
     {
-        return x >= 0 && y >= 0 &&
-               static_cast<size_t>(x) < Width &&
-               static_cast<size_t>(y) < Height;
+        return grid.isValidPosition(x, y);
     }
 
     sf::Color getCellColor(size_t row, size_t col) const
@@ -76,37 +82,54 @@ private:
 
     void drawTokens(sf::RenderWindow &window, float cellW, float cellH) const
     {
-        for (size_t row = 0; row < Height; ++row)
+        for (Token *token : placed)
         {
-            for (size_t col = 0; col < Width; ++col)
-            {
-                if (board[row][col])
-                {
-                    board[row][col]->draw(window, cellW, cellH);
-                }
-            }
+            token->draw(window, cellW, cellH);
         }
     }
 
+    void retireToken(Token *token)
+    {
+        auto it = std::find(active.begin(), active.end(), token);
+        if (it != active.end())
+        {
+            *it = active.back();
+            active.pop_back();
+        }
+    }
+
+    // True if one of player's tokens in play can move, looking at occupancy only
+    bool hasMovableToken(int player) const noexcept
+    {
+        for (const Token *token : active)
+        {
+            const auto [x, y] = token->getPosition();
+            if (token->getPlayer() == player && grid.canMove(grid.index(x, y)))
+                return true;
+        }
+        return false;
+    }
+
 public:
+    // Outcome of applyMoves(); on failure moves[applied] is the first illegal move
+    struct BatchResult
+    {
+        MoveStatus status;
+        size_t applied; // Moves applied, all of them when ok()
+        int player;     // Player to move after the applied moves
+        int scored[2];  // Tokens each player brought home during the batch
+
+        bool ok() const noexcept { return status == MoveStatus::Ok; }
+    };
+
     GameBoard(size_t width, size_t height)
         : Width(width), Height(height),
-          board(height, std::vector<Token *>(width, nullptr)) {}
+          grid(width, height),
+          tokens(grid.size(), nullptr) {}
 
     GameBoard(const GameBoard &) = delete;
     GameBoard &operator=(const GameBoard &) = delete;
 
-    ~GameBoard()
-    {
-        for (auto &row : board)
-        {
-            for (auto &cell : row)
-            {
-                cell = nullptr;
-            }
-        }
-    }
-
     void placeToken(Token *token)
     {
         const auto [x, y] = token->getPosition();
@@ -114,149 +137,214 @@ public:
         {
             throw std::out_of_range("Invalid token position");
         }
-        board[y][x] = token;
+        const size_t idx = grid.index(x, y);
+        grid.set(idx, BoardGrid::playerCell(token->getPlayer()));
+        tokens[idx] = token;
+        placed.push_back(token);
+        if (!token->hasReachedEnd())
+        {
+            active.push_back(token);
+        }
+        if (token->isMovable())
+        {
+            ++movableCount[token->getPlayer()];
+        }
     }
 
-    void moveToken(int fromX, int fromY, int toX, int toY)
+    /**
+     * Check a move without changing the board. The target must be the
+     * square in front of the token (a jump is resolved automatically) or
+     * the landing square itself; any other square is an IllegalMove, as in
+     * applyMoves() and Position::findMove(). Whose turn it is is left to
+     * the caller.
+     */
+    MoveResult checkMove(int fromX, int fromY, int toX, int toY) const noexcept
     {
         if (!isValidPosition(fromX, fromY) || !isValidPosition(toX, toY))
-        {
-            throw std::out_of_range("Move coordinates out of bounds");
-        }
+            return {MoveStatus::OutOfBounds, -1, -1};
+
+        const size_t from = grid.index(fromX, fromY);
+        if (!grid.isOccupied(from))
+            return {MoveStatus::NoToken, -1, -1};
+        if (!tokens[from]->isMovable())
+            return {MoveStatus::Immovable, -1, -1};
+
+        // Only the front square, or the square past an occupied one, is a
+        // forward move. The sentinel border makes the far square a Wall
+        // whenever the jump would leave the board
+        const size_t step = grid.forwardOffset(BoardGrid::cellPlayer(grid.at(from)));
+        const size_t front = from + step;
+        size_t to = grid.index(toX, toY);
+        if (to != front && (to != front + step || !grid.isOccupied(front)))
+            return {MoveStatus::IllegalMove, -1, -1};
+        if (to == front && !grid.isEmpty(front))
+            to += step;
+        if (!grid.isEmpty(to))
+            return {MoveStatus::CannotJump, -1, -1};
+
+        return {MoveStatus::Ok, grid.column(to), grid.row(to)};
+    }
 
-        size_t fX = fromX, fY = fromY;
-        size_t tX = toX, tY = toY;
+    // Apply a move if it is legal; the board is untouched otherwise
+    MoveResult tryMoveToken(int fromX, int fromY, int toX, int toY) noexcept
+    {
+        const MoveResult result = checkMove(fromX, fromY, toX, toY);
+        if (!result.ok())
+            return result;
 
-        if (!board[fY][fX])
-            throw std::runtime_error("No token at source position");
-        Token *movingToken = board[fY][fX];
+        const size_t from = grid.index(fromX, fromY);
+        const size_t to = grid.index(result.x, result.y);
+        Token *movingToken = tokens[from];
 
-        if (!movingToken->isMovable())
+        // Perform move
+        grid.set(to, BoardGrid::playerCell(movingToken->getPlayer()));
+        grid.set(from, BoardGrid::Empty);
+        tokens[to] = movingToken;
+        tokens[from] = nullptr;
+        movingToken->move(result.x, result.y);
+
+        // Check end condition; a token at the end never moves again
+        if (grid.isEdge(to))
         {
-            throw std::runtime_error("Token is immovable");
+            movingToken->tokenReachedEnd();
+            retireToken(movingToken);
         }
+        updateTokenMoveStatus();
+        return result;
+    }
+
+    /**
+     * Apply a recorded sequence as the game plays it, for bulk replay.
+     * Each move must be a forward move (to is the landing square or the
+     * square in front) of the player to move, who is toMove at first; the
+     * turn passes after every move unless the other player has no movable
+     * token. Moves are checked against occupancy only. The turn rule
+     * needs no mobility either while the players alternate, as the next
+     * move shows the other player could move; only a player moving twice
+     * in a row costs a scan of the other player's tokens. Movable flags
+     * and counts are refreshed once at the end. Stops at the first
+     * illegal move; the moves before it stay applied.
+     */
+    BatchResult applyMoves(const Move *moves, size_t count, int toMove) noexcept
+    {
+        BatchResult result{MoveStatus::Ok, 0, toMove, {0, 0}};
+        int remaining[2] = {0, 0}; // Tokens not home yet
+        for (const Token *token : active)
+            ++remaining[token->getPlayer()];
 
-        // Handle potential jumps
-        if (board[tY][tX])
+        int lastMover = -1;
+        for (; result.applied < count; ++result.applied)
         {
-            const int player = movingToken->getPlayer();
-            if (player == 0)
+            const Move &move = moves[result.applied];
+            const size_t from = move.from;
+            if (remaining[0] == 0 || remaining[1] == 0)
             {
-                if (tX >= Width - 1 || board[tY][tX + 1])
-                    throw std::runtime_error("Can't jump");
-                tX++;
+                result.status = MoveStatus::GameOver;
+                break;
             }
-            else if (player == 1)
+            // The Wall border stands for every square off the board, without dividing by the stride
+            if (from >= grid.size() || move.to >= grid.size() ||
+                grid.at(from) == BoardGrid::Wall || grid.at(move.to) == BoardGrid::Wall)
             {
-                if (tY >= Height - 1 || board[tY + 1][tX])
-                    throw std::runtime_error("Can't jump");
-                tY++;
+                result.status = MoveStatus::OutOfBounds;
+                break;
+            }
+            if (!grid.isOccupied(from))
+            {
+                result.status = MoveStatus::NoToken;
+                break;
+            }
+            const size_t to = grid.landingIndex(from);
+            if (to == BoardGrid::NoMove)
+            {
+                result.status = MoveStatus::Immovable;
+                break;
             }
-        }
 
-        // Validate final position
-        if (!isValidPosition(tX, tY))
-        {
-            throw std::out_of_range("Jump moves out of bounds");
+            // A movable token of the other player means the turn did pass to them
+            const int player = BoardGrid::cellPlayer(grid.at(from));
+            const size_t step = grid.forwardOffset(player);
+            const bool inTurn = lastMover < 0 ? player == toMove
+                                              : player != lastMover || !hasMovableToken(1 - player);
+            if (!inTurn || (move.to != to && move.to != from + step))
+            {
+                result.status = MoveStatus::IllegalMove;
+                break;
+            }
+
+            Token *movingToken = tokens[from];
+            const auto [x, y] = movingToken->getPosition();
+            const int distance = to == from + step ? 1 : 2;
+            grid.set(to, BoardGrid::playerCell(player));
+            grid.set(from, BoardGrid::Empty);
+            tokens[to] = movingToken;
+            tokens[from] = nullptr;
+            movingToken->move(player == 0 ? x + distance : x, player == 1 ? y + distance : y);
+            if (grid.at(to + step) == BoardGrid::Wall) // The far edge, the only one a token can reach
+            {
+                movingToken->tokenReachedEnd();
+                retireToken(movingToken);
+                --remaining[player];
+                ++result.scored[player];
+            }
+            lastMover = player;
         }
 
-        // Perform move
-        board[tY][tX] = movingToken;
-        board[fY][fX] = nullptr;
-        movingToken->move(tX, tY);
+        // As GameManager hands the turn on after the last move
         updateTokenMoveStatus();
+        if (lastMover >= 0)
+            result.player = movableCount[1 - lastMover] > 0 ? 1 - lastMover : lastMover;
+        return result;
+    }
 
-        // Check end condition
-        if (tX == 0 || tX == Width - 1 || tY == 0 || tY == Height - 1)
-        {
-            movingToken->tokenReachedEnd();
-        }
+    // Throwing wrapper around a failed MoveStatus, kept for the UI
+    static void throwMoveError(MoveStatus status)
+    {
+        if (status == MoveStatus::OutOfBounds)
+            throw std::out_of_range(moveStatusMessage(status));
+        if (status != MoveStatus::Ok)
+            throw std::runtime_error(moveStatusMessage(status));
     }
 
-    void updateTokenMoveStatus()
+    void moveToken(int fromX, int fromY, int toX, int toY)
     {
-        for (size_t row = 0; row < Height; ++row)
-        {
-            for (size_t col = 0; col < Width; ++col)
-            {
-                if (board[row][col])
-                {
-                    if (canTokenMove(board[row][col]))
-                    {
-                        board[row][col]->setMovable(true);
-                    }
-                    else
-                    {
-                        board[row][col]->setMovable(false);
-                    }
-                }
-            }
-        }
+        throwMoveError(tryMoveToken(fromX, fromY, toX, toY).status);
     }
 
-    std::pair<int, int> getTokenMove(int fromX, int fromY, int toX, int toY) const
+    // Refresh the movable flag of every token still in play; retired tokens stay immovable
+    void updateTokenMoveStatus() noexcept
     {
-        try
+        movableCount[0] = movableCount[1] = 0;
+        for (Token *token : active)
         {
-            if (!isValidPosition(fromX, fromY) || !isValidPosition(toX, toY))
-            {
-                return {-1, -1};
-            }
-
-            const Token *token = board[fromY][fromX];
-            if (!token || !token->isMovable())
-                return {-1, -1};
-
-            // Check direct move
-            if (!board[toY][toX])
-                return {toX, toY};
+            const auto [x, y] = token->getPosition();
+            const bool movable = grid.canMove(grid.index(x, y));
+            token->setMovable(movable);
+            movableCount[token->getPlayer()] += movable;
+        }
+    }
 
-            // Handle jump possibility
-            const int player = token->getPlayer();
-            if (player == 0 && toX < Width - 1 && !board[toY][toX + 1])
-            {
-                return {toX + 1, toY};
-            }
-            if (player == 1 && toY < Height - 1 && !board[toY + 1][toX])
-            {
-                return {toX, toY + 1};
-            }
+    // Number of a player's tokens that can move, as of the last move
+    int getMovableCount(int player) const noexcept
+    {
+        return movableCount[player];
+    }
 
+    std::pair<int, int> getTokenMove(int fromX, int fromY, int toX, int toY) const noexcept
+    {
+        const MoveResult result = checkMove(fromX, fromY, toX, toY);
+        if (!result.ok())
             return {-1, -1};
-        }
-        catch (...)
-        {
-            return {-1, -1};
-        }
+        return {result.x, result.y};
     }
 
-    bool canTokenMove(const Token *token) const
+    bool canTokenMove(const Token *token) const noexcept
     {
         const auto [x, y] = token->getPosition();
         if (!isValidPosition(x, y))
             return false;
 
-        const int player = token->getPlayer();
-        int dx = (player == 0) ? 1 : 0;
-        int dy = (player == 1) ? 1 : 0;
-
-        // Check basic move
-        if (!isValidPosition(x + dx, y + dy))
-            return false;
-        if (!board[y + dy][x + dx])
-            return true;
-
-        // Check jump possibility
-        if (player == 0 && x + 2 < Width)
-        {
-            return !board[y][x + 2];
-        }
-        if (player == 1 && y + 2 < Height)
-        {
-            return !board[y + 2][x];
-        }
-
-        return false;
+        return grid.canMove(grid.index(x, y));
     }
 
     void draw(sf::RenderWindow &window, float cellW, float cellH) const
@@ -277,13 +365,61 @@ public:
         drawTokens(window, cellW, cellH);
     }
 
+    // Draw another position on this board's cells, e.g. one picked in the tree view
+    void drawPosition(sf::RenderWindow &window, float cellW, float cellH, const BoardGrid &shown,
+                      const sf::Texture &player1Texture, const sf::Texture &player2Texture) const
+    {
+        for (size_t row = 0; row < Height; ++row)
+        {
+            for (size_t col = 0; col < Width; ++col)
+            {
+                drawCell(window, row, col, cellW, cellH);
+            }
+        }
+        drawGridLines(window, cellW, cellH);
+
+        // One quad per token, sized and centred as Token draws itself, and one draw call per player
+        const sf::Texture *textures[2] = {&player1Texture, &player2Texture};
+        sf::Vector2f sizes[2];
+        for (int player = 0; player < 2; ++player)
+        {
+            const sf::Vector2f texSize(textures[player]->getSize());
+            const float scale = std::min(cellW / texSize.x, cellH / texSize.y);
+            sizes[player] = sf::Vector2f(texSize.x * scale, texSize.y * scale);
+            previewQuads[player].setPrimitiveType(sf::PrimitiveType::Triangles);
+            previewQuads[player].clear();
+        }
+        static constexpr int order[6] = {0, 1, 2, 2, 1, 3};
+        for (size_t idx = shown.firstIndex(); idx < shown.endIndex(); ++idx)
+        {
+            if (!shown.isOccupied(idx))
+                continue;
+            const int player = BoardGrid::cellPlayer(shown.data()[idx]);
+            const sf::Vector2f size = sizes[player];
+            const sf::Vector2f topLeft((shown.column(idx) + 0.5f) * cellW - size.x / 2,
+                                       (shown.row(idx) + 0.5f) * cellH - size.y / 2);
+            const sf::Vector2f texSize(textures[player]->getSize());
+            const sf::Vector2f corners[4] = {{0, 0}, {1, 0}, {0, 1}, {1, 1}};
+            for (int v : order)
+            {
+                const sf::Vector2f corner = corners[v];
+                previewQuads[player].append({{topLeft.x + corner.x * size.x, topLeft.y + corner.y * size.y},
+                                             sf::Color::White,
+                                             {corner.x * texSize.x, corner.y * texSize.y}});
+            }
+        }
+        for (int player = 0; player < 2; ++player)
+            window.draw(previewQuads[player], sf::RenderStates(textures[player]));
+    }
+
     void printBoard() const
     {
-        for (const auto &row : board)
+        for (size_t row = 0; row < Height; ++row)
         {
-            for (const auto &cell : row)
+            for (size_t col = 0; col < Width; ++col)
             {
-                std::cout << (cell ? std::to_string(cell->getPlayer()) : ".") << " ";
+                const uint8_t cell = grid.at(col, row);
+                std::cout << (cell != BoardGrid::Empty ? std::to_string(BoardGrid::cellPlayer(cell)) : ".") << " ";
             }
             std::cout << "\n";
         }
@@ -293,7 +429,13 @@ public:
     {
         if (!isValidPosition(x, y))
             return nullptr;
-        return board[y][x];
+        return tokens[grid.index(x, y)];
+    }
+
+    // Occupancy grid backing this board
+    const BoardGrid &getGrid() const
+    {
+        return grid;
     }
 };
 
@@ -0,0 +1,105 @@
+#ifndef GAMECLOCK_H
+#define GAMECLOCK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+/**
+ * Chess-style clock for two players with a per-move increment.
+ *
+ * The side that moves next is not always the opponent (a player without a
+ * movable token is skipped), so the clock is handed to a player explicitly
+ * rather than toggled.
+ */
+class GameClock
+{
+public:
+    struct Control
+    {
+        int64_t initialMs = 5 * 60 * 1000;
+        int64_t incrementMs = 2000;
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Control control;
+    int64_t remaining[2];
+    int running = -1; // Player whose time is counting down, or -1 when stopped
+    Clock::time_point turnStart;
+
+    int64_t elapsedMs() const
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - turnStart).count();
+    }
+
+public:
+    GameClock() : GameClock(Control()) {}
+    explicit GameClock(const Control &timeControl)
+        : control(timeControl), remaining{timeControl.initialMs, timeControl.initialMs} {}
+
+    const Control &getControl() const { return control; }
+    int getRunning() const { return running; }
+
+    // Start counting down for player without charging anyone
+    void start(int player)
+    {
+        running = player;
+        turnStart = Clock::now();
+    }
+
+    /**
+     * The running player has moved: charge the time used, add the
+     * increment and start the clock of whoever moves next. Returns the
+     * milliseconds the move took.
+     */
+    int64_t completeMove(int nextPlayer)
+    {
+        int64_t used = 0;
+        if (running >= 0)
+        {
+            used = elapsedMs();
+            remaining[running] = std::max<int64_t>(remaining[running] - used, 0) + control.incrementMs;
+        }
+        start(nextPlayer);
+        return used;
+    }
+
+    void stop()
+    {
+        if (running >= 0)
+            remaining[running] = std::max<int64_t>(remaining[running] - elapsedMs(), 0);
+        running = -1;
+    }
+
+    // Time left for player, including the turn in progress
+    int64_t getRemainingMs(int player) const
+    {
+        if (player != running)
+            return remaining[player];
+        return std::max<int64_t>(remaining[player] - elapsedMs(), 0);
+    }
+
+    bool isFlagged(int player) const
+    {
+        return getRemainingMs(player) == 0;
+    }
+
+    // "m:ss", with tenths once under ten seconds
+    static std::string format(int64_t ms)
+    {
+        char text[32];
+        if (ms < 10000)
+            std::snprintf(text, sizeof(text), "0:%02lld.%lld", static_cast<long long>(ms / 1000),
+                          static_cast<long long>(ms % 1000 / 100));
+        else
+            std::snprintf(text, sizeof(text), "%lld:%02lld", static_cast<long long>(ms / 60000),
+                          static_cast<long long>(ms / 1000 % 60));
+        return text;
+    }
+};
+
+#endif // GAMECLOCK_H
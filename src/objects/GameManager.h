@@ -3,9 +3,20 @@
 #define GAMEMANAGER_H
 
 #include <SFML/Graphics.hpp>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <future>
 #include <iostream>
 #include <memory>
 #include "GameSate.h"
+#include "GameClock.h"
+#include "GameRecord.h"
+#include "GameTreeView.h"
+#include "MoveHeatmap.h"
+#include "TimeManager.h"
+#include "AssetCache.h"
 
 class GameManager
 {
@@ -19,8 +30,12 @@ private:
     };
 
     GameSettings settings;
+    AssetCache &assets;
+    const sf::Font &font;
     sf::RenderWindow window;
     GameState state;
+    GameTreeView treeView;
+    MoveHeatmap heatmap;
     bool tokenSelected;
     sf::Vector2i selectedPosition;
     sf::Vector2i possibleMove;
@@ -28,32 +43,48 @@ private:
     bool gameWon = false;
     sf::Text winText;
     sf::RectangleShape winOverlay;
-    sf::Font font;
 
     std::string player1Name;
     std::string player2Name;
 
+    // Clocks shown in a strip under the board
+    static constexpr float ClockStripHeight = 40.0f;
+    GameClock clock;
+    MoveTimeLog timeLog;
+    int64_t clockUsedMs = 0; // Clock time of the last completed move
+    sf::Text clockTexts[2];
+
+    // Players named "CPU..." are played by a search running in the background
+    bool computerPlayer[2];
+    Search engine{64};
+    std::atomic<bool> stopThinking{false};
+    std::future<Search::Info> thinking;
+    int64_t thinkingDeadlineMs = 0;
+
+    // Replay of the moves so far, scrubbed on a timeline that takes the place of the clocks
+    static constexpr float TimelineLeft = 150.0f;
+    static constexpr float TimelineRight = 15.0f;
+    GameRecord record;
+    Position replayPosition;
+    size_t replayPly = 0;
+    bool replaying = false;
+    bool scrubbing = false;
+    bool reviewOnly = false; // A finished game opened for review
+    sf::Text replayText;
+
     void handleTokenSelection(const sf::Vector2i &gridPos)
     {
-        try
+        if (auto *token = state.getBoard().getTokenAt(gridPos.x, gridPos.y))
         {
-            if (auto *token = state.getBoard().getTokenAt(gridPos.x, gridPos.y))
+            if (token->getPlayer() == state.getCurrentPlayer().getPlayerNumber())
             {
-                if (token->getPlayer() == state.getCurrentPlayer().getPlayerNumber())
-                {
-                    tokenSelected = true;
-                    selectedPosition = gridPos;
-                    calculatePossibleMove(gridPos);
-                    return;
-                }
+                tokenSelected = true;
+                selectedPosition = gridPos;
+                calculatePossibleMove(gridPos);
+                return;
             }
-            resetSelection();
-        }
-        catch (const std::exception &ex)
-        {
-            std::cerr << "Selection error: " << ex.what() << std::endl;
-            resetSelection();
         }
+        resetSelection();
     }
 
     void calculatePossibleMove(const sf::Vector2i &gridPos)
@@ -69,42 +100,278 @@ private:
 
     void handleTokenMove(const sf::Vector2i &gridPos)
     {
-        try
+        const int mover = state.getCurrentPlayer().getPlayerNumber();
+        const int64_t clockBefore = clock.getRemainingMs(mover);
+        if (applyMove(selectedPosition.x, selectedPosition.y, gridPos.x, gridPos.y))
+            timeLog.record(mover, clockUsedMs, clockBefore);
+        resetSelection();
+    }
+
+    // Play a move for the current player and hand the turn on; false if illegal
+    bool applyMove(int fromX, int fromY, int toX, int toY)
+    {
+        const MoveStatus status = state.tryMoveToken(fromX, fromY, toX, toY);
+        if (status != MoveStatus::Ok)
         {
-            state.moveToken(
-                selectedPosition.x, selectedPosition.y,
-                gridPos.x, gridPos.y);
+            std::cerr << "Move error: " << moveStatusMessage(status) << std::endl;
+            return false;
+        }
 
-            checkWinCondition();
-            checkOtherPlayerMoves();
+        // A replay showing the latest move follows the game
+        const bool following = replayPly == record.getPlies();
+        if (!record.play(fromX, fromY, toX, toY))
+            std::cerr << "Game record disagrees with the board" << std::endl;
+        if (replaying && following)
+            seekReplay(record.getPlies());
 
-            resetSelection();
+        checkWinCondition();
+        checkOtherPlayerMoves();
+        clockUsedMs = clock.completeMove(state.getCurrentPlayer().getPlayerNumber());
+        treeView.setRoot(state.toPosition());
+        startTurnAnalysis();
+        if (gameWon)
+            endGame();
+        return true;
+    }
+
+    void checkWinCondition()
+    {
+        if (state.getCurrentPlayer().getScore() >= settings.maxTokens)
+        {
+            gameWon = true;
+            setupWinScreen(state.getCurrentPlayer().getPlayerNumber(), " wins!");
+        }
+    }
+
+    void checkFlag()
+    {
+        const int player = state.getCurrentPlayer().getPlayerNumber();
+        if (gameWon || !clock.isFlagged(player))
+            return;
+        gameWon = true;
+        setupWinScreen(1 - player, " wins on time!");
+        endGame();
+    }
+
+    // Value the moves of a human player's turn while they think; the computer needs the CPU itself
+    void startTurnAnalysis()
+    {
+        if (gameWon || computerPlayer[state.getCurrentPlayer().getPlayerNumber()])
+            heatmap.clear();
+        else
+            heatmap.setPosition(state.toPosition());
+    }
+
+    void saveGame()
+    {
+        try
+        {
+            state.toSnapshot(player1Name, player2Name).save(SavePath);
+            // The moves so far go alongside, so a resumed game keeps its whole record
+            if (record.getPlies() > 0)
+                record.save(SaveRecordPath);
+            else
+                std::remove(SaveRecordPath);
+            std::cout << "Game saved to " << SavePath << "\n";
+        }
+        catch (const std::exception &ex)
+        {
+            std::cerr << "Save failed: " << ex.what() << std::endl;
+        }
+    }
+
+    void saveRecord()
+    {
+        if (record.getPlies() == 0)
+            return;
+        try
+        {
+            record.save(RecordPath);
         }
         catch (const std::exception &ex)
         {
-            std::cerr << "Move error: " << ex.what() << std::endl;
+            std::cerr << "Saving the game record failed: " << ex.what() << std::endl;
+        }
+    }
+
+    void endGame()
+    {
+        saveRecord();
+        std::remove(SavePath); // A finished game cannot be resumed
+        std::remove(SaveRecordPath);
+        clock.stop();
+        stopThinking = true;
+        std::cout << "Move times:\n";
+        timeLog.print(std::cout);
+    }
+
+    // Start a search for a computer player on move, or play its move once found
+    void updateComputerPlayer()
+    {
+        const int player = state.getCurrentPlayer().getPlayerNumber();
+        if (gameWon || !computerPlayer[player])
+            return;
+
+        if (!thinking.valid())
+        {
+            const Position pos = state.toPosition();
+            if (pos.isGameOver())
+                return;
+
+            const TimeManager::Budget budget = TimeManager::plan(pos, clock.getRemainingMs(player),
+                                                                 clock.getControl().incrementMs);
+            Search::Limits limits;
+            limits.softTimeMs = budget.softMs;
+            limits.movetimeMs = budget.hardMs;
+            limits.stop = &stopThinking;
+            thinkingDeadlineMs = budget.hardMs;
+            thinking = std::async(std::launch::async, [this, pos, limits]()
+                                  { return engine.run(pos, limits); });
+            return;
+        }
+
+        if (thinking.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return;
+
+        const Search::Info info = thinking.get();
+        if (!info.hasMove)
+            return;
+
+        const int64_t searchMs = static_cast<int64_t>(info.seconds * 1000);
+        if (timeLog.record(player, searchMs, thinkingDeadlineMs))
+        {
+            std::cout << "Deadline missed: " << searchMs << " ms of " << thinkingDeadlineMs << " ms\n";
+        }
+
+        const Position pos = state.toPosition();
+        const BoardGrid &grid = pos.getGrid();
+        resetSelection();
+        applyMove(grid.column(info.bestMove.from), grid.row(info.bestMove.from),
+                  grid.column(info.bestMove.to), grid.row(info.bestMove.to));
+    }
+
+    void renderClocks()
+    {
+        const float top = settings.cellSize * settings.size;
+        sf::RectangleShape strip({static_cast<float>(window.getSize().x), ClockStripHeight});
+        strip.setPosition({0.0f, top});
+        strip.setFillColor(sf::Color(40, 40, 40));
+        window.draw(strip);
+
+        for (int player = 0; player < 2; ++player)
+        {
+            sf::Text &text = clockTexts[player];
+            const int64_t remaining = clock.getRemainingMs(player);
+            text.setString((player == 0 ? player1Name : player2Name) + "  " + GameClock::format(remaining));
+            text.setFillColor(remaining == 0                  ? sf::Color::Red
+                              : clock.getRunning() == player ? sf::Color::Yellow
+                                                             : sf::Color::White);
+            const float x = player == 0 ? 10.0f : window.getSize().x / 2.0f + 10.0f;
+            text.setPosition({x, top + 8.0f});
+            window.draw(text);
+        }
+    }
+
+    void seekReplay(size_t ply)
+    {
+        replayPly = std::min(ply, record.getPlies());
+        record.seek(replayPly, replayPosition);
+    }
+
+    void toggleReplay()
+    {
+        replaying = !replaying;
+        scrubbing = false;
+        if (replaying)
+        {
             resetSelection();
+            seekReplay(record.getPlies());
         }
     }
 
-    void checkWinCondition()
+    size_t plyAt(float x) const
     {
-        if (state.getCurrentPlayer().getScore() >= settings.maxTokens)
+        const float width = window.getSize().x - TimelineLeft - TimelineRight;
+        const float fraction = std::clamp((x - TimelineLeft) / width, 0.0f, 1.0f);
+        return static_cast<size_t>(fraction * record.getPlies() + 0.5f);
+    }
+
+    void handleReplayKey(sf::Keyboard::Key key)
+    {
+        switch (key)
         {
-            gameWon = true;
-            setupWinScreen();
+        case sf::Keyboard::Key::Left:
+            seekReplay(replayPly > 0 ? replayPly - 1 : 0);
+            break;
+        case sf::Keyboard::Key::Right:
+            seekReplay(replayPly + 1);
+            break;
+        case sf::Keyboard::Key::PageUp:
+            seekReplay(replayPly > GameRecord::KeyframeInterval ? replayPly - GameRecord::KeyframeInterval : 0);
+            break;
+        case sf::Keyboard::Key::PageDown:
+            seekReplay(replayPly + GameRecord::KeyframeInterval);
+            break;
+        case sf::Keyboard::Key::Home:
+            seekReplay(0);
+            break;
+        case sf::Keyboard::Key::End:
+            seekReplay(record.getPlies());
+            break;
+        default:
+            break;
         }
     }
 
-    void setupWinScreen()
+    // Outline the squares of the move that led to the shown ply
+    void renderReplayMove()
     {
-        // Load font if not already loaded
-        if (!font.openFromFile("arial.ttf"))
+        if (replayPly == 0)
+            return;
+        const Move &move = record.getMove(replayPly - 1);
+        const BoardGrid &grid = replayPosition.getGrid();
+        for (size_t idx : {size_t(move.from), size_t(move.to)})
         {
-            std::cerr << "Error loading font for win screen!\n";
-            // Handle error
+            sf::RectangleShape square({settings.cellSize, settings.cellSize});
+            square.setPosition({grid.column(idx) * settings.cellSize, grid.row(idx) * settings.cellSize});
+            square.setFillColor(sf::Color::Transparent);
+            square.setOutlineColor(sf::Color(255, 160, 0));
+            square.setOutlineThickness(-3);
+            window.draw(square);
         }
+    }
+
+    void renderTimeline()
+    {
+        const float top = settings.cellSize * settings.size;
+        const float width = window.getSize().x - TimelineLeft - TimelineRight;
+        sf::RectangleShape strip({static_cast<float>(window.getSize().x), ClockStripHeight});
+        strip.setPosition({0.0f, top});
+        strip.setFillColor(sf::Color(40, 40, 40));
+        window.draw(strip);
 
+        replayText.setString("Ply " + std::to_string(replayPly) + " / " + std::to_string(record.getPlies()));
+        replayText.setPosition({10.0f, top + 8.0f});
+        window.draw(replayText);
+
+        const float fraction = record.getPlies() ? static_cast<float>(replayPly) / record.getPlies() : 1.0f;
+        sf::RectangleShape track({width, 4.0f});
+        track.setPosition({TimelineLeft, top + ClockStripHeight / 2 - 2.0f});
+        track.setFillColor(sf::Color(90, 90, 90));
+        window.draw(track);
+        track.setSize({width * fraction, 4.0f});
+        track.setFillColor(sf::Color(255, 160, 0));
+        window.draw(track);
+
+        sf::CircleShape handle(7.0f);
+        handle.setOrigin({7.0f, 7.0f});
+        handle.setPosition({TimelineLeft + width * fraction, top + ClockStripHeight / 2});
+        handle.setFillColor(scrubbing ? sf::Color::Yellow : sf::Color::White);
+        window.draw(handle);
+    }
+
+    void setupWinScreen(int winner, const std::string &message)
+    {
         // Create dark overlay
         winOverlay.setSize(sf::Vector2f(window.getSize()));
         winOverlay.setFillColor(sf::Color(0, 0, 0, 200));
@@ -116,10 +383,8 @@ private:
         winText.setStyle(sf::Text::Bold);
 
         // Use player names instead of numbers
-        std::string winnerName = state.getCurrentPlayer().getPlayerNumber() == 0
-                                     ? player1Name
-                                     : player2Name;
-        winText.setString(winnerName + " wins!");
+        std::string winnerName = winner == 0 ? player1Name : player2Name;
+        winText.setString(winnerName + message);
 
         // Center text
         sf::FloatRect textRect = winText.getLocalBounds();
@@ -152,11 +417,59 @@ private:
         {
             if (event->is<sf::Event::Closed>())
             {
+                if (!gameWon && !reviewOnly)
+                    saveGame();
+                saveRecord();
                 window.close();
             }
 
+            if (auto *keyPress = event->getIf<sf::Event::KeyPressed>())
+            {
+                if (keyPress->code == sf::Keyboard::Key::T)
+                    treeView.open();
+                else if (keyPress->code == sf::Keyboard::Key::S && !gameWon && !reviewOnly)
+                    saveGame();
+                else if (keyPress->code == sf::Keyboard::Key::H)
+                    heatmap.toggle();
+                else if (keyPress->code == sf::Keyboard::Key::R && !reviewOnly)
+                    toggleReplay();
+                else if (replaying)
+                    handleReplayKey(keyPress->code);
+            }
+
+            // Dragging along the timeline seeks; the board takes no moves while replaying
+            if (replaying)
+            {
+                if (auto *press = event->getIf<sf::Event::MouseButtonPressed>())
+                {
+                    scrubbing = press->position.y >= settings.cellSize * settings.size;
+                    if (scrubbing)
+                        seekReplay(plyAt(static_cast<float>(press->position.x)));
+                }
+                else if (auto *moved = event->getIf<sf::Event::MouseMoved>(); moved && scrubbing)
+                {
+                    seekReplay(plyAt(static_cast<float>(moved->position.x)));
+                }
+                else if (event->is<sf::Event::MouseButtonReleased>())
+                {
+                    scrubbing = false;
+                }
+                continue;
+            }
+
             if (auto *mousePress = event->getIf<sf::Event::MouseButtonPressed>())
             {
+                // A click on the board leaves the tree preview before playing on
+                if (treeView.hasPreview())
+                {
+                    treeView.clearPreview();
+                    continue;
+                }
+
+                // The computer plays its own moves
+                if (gameWon || computerPlayer[state.getCurrentPlayer().getPlayerNumber()])
+                    continue;
+
                 const auto mousePos = sf::Mouse::getPosition(window);
                 const sf::Vector2i gridPos(
                     static_cast<int>(mousePos.x / settings.cellSize),
@@ -202,17 +515,130 @@ private:
     }
 
 public:
-    GameManager(size_t gameSize, const std::string &player1, const std::string &player2)
+    // Closing an unfinished game leaves it here for the menu to resume
+    static constexpr const char *SavePath = "savegame.gts";
+
+    // Moves of the saved game up to SavePath's position, continued when it is resumed
+    static constexpr const char *SaveRecordPath = "savegame.gtr";
+
+    // Moves of the last game played, for the menu to replay
+    static constexpr const char *RecordPath = "lastgame.gtr";
+
+    // Assets must already be finalized so no file is touched once the window is up
+    GameManager(size_t gameSize, const std::string &player1, const std::string &player2,
+                AssetCache &assets, const GameClock::Control &timeControl = {})
+        : GameManager(newGameSnapshot(gameSize, player1, player2), assets, timeControl) {}
+
+    // Resume a saved game; clocks start afresh
+    GameManager(const GameSnapshot &snapshot, AssetCache &assets, const GameClock::Control &timeControl = {})
         : settings{
-              gameSize,
-              gameSize - 2,
-              static_cast<float>(600) / gameSize, // Cell size calculated from known window size
-              sf::VideoMode({600, 600})},
-          window(settings.videoMode, "Token Game"), state(settings.cellSize, settings.cellSize, gameSize), tokenSelected(false), winText(font, "", 30)
-    {
-        player1Name = player1;
-        player2Name = player2;
+              snapshot.boardSize,
+              snapshot.boardSize - 2,
+              static_cast<float>(600) / snapshot.boardSize, // Cell size calculated from known window size
+              sf::VideoMode({600, 600 + static_cast<unsigned>(ClockStripHeight)})},
+          assets(assets),
+          font(assets.getFont()),
+          window(settings.videoMode, "Token Game"),
+          state(settings.cellSize, settings.cellSize, snapshot,
+                assets.getTokenTexture(0), assets.getTokenTexture(1)),
+          treeView(font, state.toPosition()),
+          heatmap(settings.cellSize, state.toPosition()),
+          tokenSelected(false), winText(font, "", 30),
+          clock(timeControl),
+          clockTexts{sf::Text(font, "", 22), sf::Text(font, "", 22)},
+          record(snapshot),
+          replayPosition(record.getLast()),
+          replayText(font, "", 22)
+    {
+        player1Name = snapshot.names[0];
+        player2Name = snapshot.names[1];
+        computerPlayer[0] = isComputerName(player1Name);
+        computerPlayer[1] = isComputerName(player2Name);
         window.setFramerateLimit(60);
+        clock.start(state.getCurrentPlayer().getPlayerNumber());
+        startTurnAnalysis();
+        std::cout << "Press T to open the game tree explorer, H for the move heatmap, R to replay the game, "
+                     "S to save; closing the window saves the game\n";
+    }
+
+    // Resume a saved game and go on recording after the moves that led to it
+    GameManager(const GameSnapshot &snapshot, const GameRecord &history, AssetCache &assets,
+                const GameClock::Control &timeControl = {})
+        : GameManager(snapshot, assets, timeControl)
+    {
+        record = history;
+        seekReplay(record.getPlies());
+    }
+
+    /**
+     * Open a recorded game at its last move with the replay showing. A
+     * finished game can only be reviewed; an unfinished one can be played
+     * on once the replay is closed.
+     */
+    GameManager(const GameRecord &played, AssetCache &assets, const GameClock::Control &timeControl = {})
+        : GameManager(finalSnapshot(played), assets, timeControl)
+    {
+        record = played;
+        reviewOnly = played.getLast().isGameOver();
+        if (reviewOnly)
+        {
+            clock.stop();
+            heatmap.clear();
+        }
+        replaying = true;
+        seekReplay(record.getPlies());
+    }
+
+    static GameSnapshot finalSnapshot(const GameRecord &played)
+    {
+        GameSnapshot snapshot = GameSnapshot::fromPosition(played.getLast());
+        snapshot.names[0] = played.getStart().names[0];
+        snapshot.names[1] = played.getStart().names[1];
+        return snapshot;
+    }
+
+    // Record saved with snapshot, or a new one starting at it if there is none or it leads elsewhere
+    static GameRecord savedRecord(const GameSnapshot &snapshot)
+    {
+        try
+        {
+            GameRecord saved = GameRecord::load(SaveRecordPath);
+            if (saved.getLast().getHash() == snapshot.toPosition().getHash())
+                return saved;
+        }
+        catch (...)
+        {
+            // Missing or damaged; the game goes on from the snapshot alone
+        }
+        return GameRecord(snapshot);
+    }
+
+    static GameSnapshot newGameSnapshot(size_t gameSize, const std::string &player1, const std::string &player2)
+    {
+        GameSnapshot snapshot = GameSnapshot::fromPosition(Position(gameSize));
+        snapshot.names[0] = player1;
+        snapshot.names[1] = player2;
+        return snapshot;
+    }
+
+    ~GameManager()
+    {
+        // std::future from std::async waits for the search in its destructor
+        stopThinking = true;
+    }
+
+    // "CPU", "cpu 2", ... are played by the computer
+    static bool isComputerName(const std::string &name)
+    {
+        static const std::string prefix = "cpu";
+        if (name.size() < prefix.size())
+            return false;
+        for (size_t i = 0; i < prefix.size(); ++i)
+        {
+            if (std::tolower(static_cast<unsigned char>(name[i])) != prefix[i])
+                return false;
+        }
+        return true;
     }
 
     void run()
@@ -220,10 +646,35 @@ public:
         while (window.isOpen())
         {
             handleEvents();
+            checkFlag();
+            updateComputerPlayer();
+            treeView.update();
+            heatmap.update();
 
             window.clear(sf::Color::White);
-            state.getBoard().draw(window, settings.cellSize, settings.cellSize);
-            renderSelection();
+            if (replaying)
+            {
+                state.getBoard().drawPosition(window, settings.cellSize, settings.cellSize,
+                                              replayPosition.getGrid(),
+                                              assets.getTokenTexture(0), assets.getTokenTexture(1));
+                renderReplayMove();
+            }
+            else if (treeView.hasPreview())
+            {
+                state.getBoard().drawPosition(window, settings.cellSize, settings.cellSize,
+                                              treeView.getPreview().getGrid(),
+                                              assets.getTokenTexture(0), assets.getTokenTexture(1));
+            }
+            else
+            {
+                state.getBoard().draw(window, settings.cellSize, settings.cellSize);
+                heatmap.draw(window);
+                renderSelection();
+            }
+            if (replaying)
+                renderTimeline();
+            else
+                renderClocks();
 
             if (gameWon)
             {
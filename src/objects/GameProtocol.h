@@ -0,0 +1,287 @@
+#ifndef GAMEPROTOCOL_H
+#define GAMEPROTOCOL_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include "Position.h"
+
+/**
+ * Binary protocol of the game server.
+ *
+ * Every frame is a 16-bit little-endian length followed by that many
+ * bytes: a message type and its fields. Integers are little endian and
+ * board coordinates are single bytes. A connection may drive any number
+ * of sessions; each session-scoped request is answered in order.
+ *
+ *   Client to server                  Server to client
+ *   Create  tag size computers depth  Created  tag session
+ *   Join    session                   Snapshot session GameSnapshot bytes
+ *   Move    session fx fy tx ty       Moved    session fx fy tx ty side score0 score1 status
+ *   State   session                   Snapshot ...
+ *   Analyze session depth             Analysis session fx fy tx ty score(i32) depth
+ *   Latency session (0: server)       Latency  session count p50 p90 p99 max (u32 microseconds)
+ *   Close   session                   Closed   session
+ *                                     Error    session request code
+ *
+ * computers is a bit mask of the players the server plays itself. Moved
+ * goes to every connection that created or joined the session, for both
+ * client and server moves; tx ty is where the token landed.
+ */
+namespace GameProtocol
+{
+    enum class MessageType : uint8_t
+    {
+        Create = 1,
+        Join = 2,
+        Move = 3,
+        State = 4,
+        Analyze = 5,
+        Latency = 6,
+        Close = 7,
+
+        Created = 64,
+        Moved = 65,
+        Snapshot = 66,
+        Analysis = 67,
+        LatencyReport = 68,
+        Closed = 69,
+        Error = 127
+    };
+
+    // The first values match MoveStatus
+    enum class ErrorCode : uint8_t
+    {
+        OutOfBounds = 1,
+        NoToken = 2,
+        Immovable = 3,
+        CannotJump = 4,
+        IllegalMove = 16, // Not a forward move of the side to move
+        GameOver = 17,
+        ComputerTurn = 18,
+        UnknownSession = 19,
+        BadRequest = 20,
+        ServerFull = 21
+    };
+
+    enum class GameStatus : uint8_t
+    {
+        Playing = 0,
+        Player1Won = 1,
+        Player2Won = 2,
+        Blocked = 3 // Nobody can move
+    };
+
+    constexpr uint8_t NoSquare = 0xff; // Coordinates of a missing move
+
+    inline GameStatus statusOf(const Position &pos)
+    {
+        const int winner = pos.winner();
+        if (winner >= 0)
+            return winner == 0 ? GameStatus::Player1Won : GameStatus::Player2Won;
+        return pos.isGameOver() ? GameStatus::Blocked : GameStatus::Playing;
+    }
+
+    // Appends one frame to a buffer; the length is filled in by the destructor
+    class FrameWriter
+    {
+    private:
+        std::string &out;
+        size_t start;
+
+    public:
+        FrameWriter(std::string &buffer, MessageType type) : out(buffer), start(buffer.size())
+        {
+            out.append(2, '\0');
+            out += static_cast<char>(type);
+        }
+
+        ~FrameWriter()
+        {
+            const size_t length = out.size() - start - 2;
+            out[start] = static_cast<char>(length & 0xff);
+            out[start + 1] = static_cast<char>(length >> 8);
+        }
+
+        FrameWriter(const FrameWriter &) = delete;
+        FrameWriter &operator=(const FrameWriter &) = delete;
+
+        FrameWriter &u8(uint8_t value)
+        {
+            out += static_cast<char>(value);
+            return *this;
+        }
+
+        FrameWriter &u32(uint32_t value)
+        {
+            for (int i = 0; i < 4; ++i)
+                out += static_cast<char>(value >> (8 * i));
+            return *this;
+        }
+
+        FrameWriter &i32(int32_t value) { return u32(static_cast<uint32_t>(value)); }
+
+        FrameWriter &bytes(const std::string &data)
+        {
+            out += data;
+            return *this;
+        }
+    };
+
+    // Reads the fields of one frame; ok() turns false on reading past the end
+    class FrameReader
+    {
+    private:
+        const uint8_t *data;
+        size_t length;
+        size_t offset = 0;
+        bool valid = true;
+
+    public:
+        FrameReader(const uint8_t *frame, size_t size) : data(frame), length(size) {}
+
+        bool ok() const { return valid; }
+        bool atEnd() const { return offset == length; }
+
+        uint8_t u8()
+        {
+            if (offset + 1 > length)
+            {
+                valid = false;
+                return 0;
+            }
+            return data[offset++];
+        }
+
+        uint32_t u32()
+        {
+            if (offset + 4 > length)
+            {
+                valid = false;
+                return 0;
+            }
+            uint32_t value = 0;
+            for (int i = 0; i < 4; ++i)
+                value |= static_cast<uint32_t>(data[offset + i]) << (8 * i);
+            offset += 4;
+            return value;
+        }
+
+        int32_t i32() { return static_cast<int32_t>(u32()); }
+
+        std::string rest()
+        {
+            std::string tail(reinterpret_cast<const char *>(data + offset), length - offset);
+            offset = length;
+            return tail;
+        }
+    };
+
+    /**
+     * Find the next complete frame in buffer at offset. Returns false if
+     * more bytes are needed; otherwise points type and fields at the frame
+     * and moves offset past it.
+     */
+    inline bool nextFrame(const std::string &buffer, size_t &offset, MessageType &type, FrameReader &fields)
+    {
+        if (buffer.size() - offset < 2)
+            return false;
+        const uint8_t *data = reinterpret_cast<const uint8_t *>(buffer.data()) + offset;
+        const size_t length = data[0] | (static_cast<size_t>(data[1]) << 8);
+        if (buffer.size() - offset - 2 < length)
+            return false;
+        offset += 2 + length;
+        if (length == 0)
+        {
+            type = MessageType::Error;
+            fields = FrameReader(data + 2, 0);
+            return true;
+        }
+        type = static_cast<MessageType>(data[2]);
+        fields = FrameReader(data + 3, length - 1);
+        return true;
+    }
+
+    /**
+     * Latency histogram with four buckets per power of two of
+     * microseconds, so percentiles are within 25% at any scale while a
+     * session's histogram stays under half a kilobyte.
+     */
+    class LatencyHistogram
+    {
+    public:
+        static constexpr int SubBuckets = 4;
+        static constexpr int Buckets = SubBuckets * 27; // Up to about 4.5 minutes
+
+    private:
+        std::array<uint32_t, Buckets> counts{};
+        uint32_t total = 0;
+        uint32_t maxMicros = 0;
+
+        static int bucketOf(uint64_t micros)
+        {
+            if (micros < SubBuckets)
+                return static_cast<int>(micros);
+            int top = 63;
+            while (!(micros >> top))
+                --top;
+            const int bucket = SubBuckets * (top - 1) + static_cast<int>((micros >> (top - 2)) & (SubBuckets - 1));
+            return bucket < Buckets ? bucket : Buckets - 1;
+        }
+
+        // Largest value that falls into bucket
+        static uint64_t upperBound(int bucket)
+        {
+            if (bucket < SubBuckets)
+                return static_cast<uint64_t>(bucket);
+            const int top = bucket / SubBuckets + 1;
+            const uint64_t low = static_cast<uint64_t>(SubBuckets + bucket % SubBuckets) << (top - 2);
+            return low + (uint64_t(1) << (top - 2)) - 1;
+        }
+
+    public:
+        void record(uint64_t micros)
+        {
+            ++counts[bucketOf(micros)];
+            ++total;
+            maxMicros = std::max<uint32_t>(maxMicros, static_cast<uint32_t>(std::min<uint64_t>(micros, UINT32_MAX)));
+        }
+
+        void merge(const LatencyHistogram &other)
+        {
+            for (int i = 0; i < Buckets; ++i)
+                counts[i] += other.counts[i];
+            total += other.total;
+            maxMicros = std::max(maxMicros, other.maxMicros);
+        }
+
+        void clear() { *this = LatencyHistogram(); }
+
+        uint32_t count() const { return total; }
+        uint32_t max() const { return maxMicros; }
+
+        // Smallest recorded latency bound that fraction of the samples do not exceed
+        uint32_t percentile(double fraction) const
+        {
+            if (total == 0)
+                return 0;
+            const uint64_t wanted = std::max<uint64_t>(1, static_cast<uint64_t>(fraction * total + 0.999999));
+            uint64_t seen = 0;
+            for (int i = 0; i < Buckets; ++i)
+            {
+                seen += counts[i];
+                if (seen >= wanted)
+                    return static_cast<uint32_t>(std::min<uint64_t>(upperBound(i), maxMicros));
+            }
+            return maxMicros;
+        }
+
+        void write(FrameWriter &frame) const
+        {
+            frame.u32(total).u32(percentile(0.5)).u32(percentile(0.9)).u32(percentile(0.99)).u32(maxMicros);
+        }
+    };
+}
+
+#endif // GAMEPROTOCOL_H
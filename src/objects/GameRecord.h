@@ -0,0 +1,153 @@
+#ifndef GAMERECORD_H
+#define GAMERECORD_H
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "ChecksummedFile.h"
+#include "GameSnapshot.h"
+#include "Position.h"
+
+/**
+ * Moves of a game with periodic keyframes, for showing it at any ply.
+ *
+ * Every KeyframeInterval plies a copy of the position is kept, so seeking
+ * anywhere costs one keyframe copy plus fewer than KeyframeInterval moves
+ * on the Position rules, however long the game is.
+ *
+ * File layout: "GTRC", version, u16 start snapshot length and the
+ * GameSnapshot bytes, u32 ply count, then fromX fromY toX toY bytes per
+ * move (to is the landing square), then FNV-1a of all preceding bytes
+ * (8 bytes, little endian). Integers are little endian. Keyframes are
+ * rebuilt while loading, which checks every move.
+ */
+class GameRecord
+{
+public:
+    static constexpr char Magic[4] = {'G', 'T', 'R', 'C'};
+    static constexpr uint8_t Version = 1;
+    static constexpr size_t KeyframeInterval = 32;
+
+private:
+    GameSnapshot start;
+    std::vector<Move> moves;
+    std::vector<Position> keyframes; // Position before ply i * KeyframeInterval
+    Position last;
+
+public:
+    explicit GameRecord(const GameSnapshot &startSnapshot)
+        : start(startSnapshot), last(startSnapshot.toPosition())
+    {
+        keyframes.push_back(last);
+    }
+
+    // Append the side to move's move, given as GameBoard::checkMove takes it; false if illegal
+    bool play(int fromX, int fromY, int toX, int toY)
+    {
+        Move move;
+        if (!last.findMove(fromX, fromY, toX, toY, move))
+            return false;
+        last.makeMove(move);
+        moves.push_back(move);
+        if (moves.size() % KeyframeInterval == 0)
+            keyframes.push_back(last);
+        return true;
+    }
+
+    size_t getPlies() const { return moves.size(); }
+    const GameSnapshot &getStart() const { return start; }
+    const Position &getLast() const { return last; }
+
+    // Move made at ply, counting from 0
+    const Move &getMove(size_t ply) const { return moves[ply]; }
+
+    // Set pos to the position after ply moves; reuses pos's storage, so scrubbing does not allocate
+    void seek(size_t ply, Position &pos) const
+    {
+        ply = std::min(ply, moves.size());
+        pos = keyframes[ply / KeyframeInterval];
+        for (size_t i = ply - ply % KeyframeInterval; i < ply; ++i)
+            pos.makeMove(moves[i]);
+    }
+
+    Position positionAt(size_t ply) const
+    {
+        Position pos = keyframes[0];
+        seek(ply, pos);
+        return pos;
+    }
+
+    std::string encode() const
+    {
+        const std::string snapshot = start.encode();
+        std::string bytes(Magic, sizeof(Magic));
+        bytes.reserve(sizeof(Magic) + 7 + snapshot.size() + 4 * moves.size() + ChecksummedFile::ChecksumSize);
+        bytes += static_cast<char>(Version);
+        bytes += static_cast<char>(snapshot.size() & 0xff);
+        bytes += static_cast<char>(snapshot.size() >> 8);
+        bytes += snapshot;
+        for (int i = 0; i < 4; ++i)
+            bytes += static_cast<char>(moves.size() >> (8 * i));
+
+        const BoardGrid &grid = last.getGrid();
+        for (const Move &move : moves)
+        {
+            bytes += static_cast<char>(grid.column(move.from));
+            bytes += static_cast<char>(grid.row(move.from));
+            bytes += static_cast<char>(grid.column(move.to));
+            bytes += static_cast<char>(grid.row(move.to));
+        }
+
+        ChecksummedFile::appendChecksum(bytes);
+        return bytes;
+    }
+
+    static GameRecord decode(const std::string &bytes)
+    {
+        const uint8_t *data = reinterpret_cast<const uint8_t *>(bytes.data());
+        const size_t header = sizeof(Magic) + 3;
+        if (bytes.size() < header + 4 + ChecksummedFile::ChecksumSize ||
+            bytes.compare(0, sizeof(Magic), Magic, sizeof(Magic)) != 0)
+            throw std::runtime_error("Not a game record");
+        if (data[4] != Version)
+            throw std::runtime_error("Unsupported game record version");
+
+        const size_t body = ChecksummedFile::verifyChecksum(bytes, "Game record");
+
+        const size_t snapshotSize = data[5] | (static_cast<size_t>(data[6]) << 8);
+        if (header + snapshotSize + 4 > body)
+            throw std::runtime_error("Game record has the wrong length");
+        GameRecord record(GameSnapshot::decode(bytes.substr(header, snapshotSize)));
+
+        size_t offset = header + snapshotSize;
+        uint32_t plies = 0;
+        for (int i = 0; i < 4; ++i)
+            plies |= static_cast<uint32_t>(data[offset + i]) << (8 * i);
+        offset += 4;
+        if (body - offset != 4 * static_cast<size_t>(plies))
+            throw std::runtime_error("Game record has the wrong length");
+
+        record.moves.reserve(plies);
+        for (; offset < body; offset += 4)
+        {
+            if (!record.play(data[offset], data[offset + 1], data[offset + 2], data[offset + 3]))
+                throw std::runtime_error("Game record move " + std::to_string(record.moves.size() + 1) + " is illegal");
+        }
+        return record;
+    }
+
+    // Replaces path atomically, like GameSnapshot::save
+    void save(const std::string &path) const
+    {
+        ChecksummedFile::write(path, encode());
+    }
+
+    static GameRecord load(const std::string &path)
+    {
+        return decode(ChecksummedFile::read(path));
+    }
+};
+
+#endif // GAMERECORD_H
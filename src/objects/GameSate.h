@@ -3,6 +3,8 @@
 
 #include "Player.h"
 #include "GameBoard.h"
+#include "Position.h"
+#include "GameSnapshot.h"
 #include <stdexcept>
 
 class GameState
@@ -14,12 +16,14 @@ private:
     Player player2;
     int currentPlayer;
 
-    void initializeTokens(float cellW, float cellH)
+    void initializeTokens(float cellW, float cellH,
+                          const sf::Texture &player1Texture,
+                          const sf::Texture &player2Texture)
     {
         for (size_t i = 0; i < MaxTokensPerPlayer; ++i)
         {
-            Token *token1 = new Token(0, i + 1, 0, "rtoken.png", cellW, cellH);
-            Token *token2 = new Token(i + 1, 0, 1, "gtoken.png", cellW, cellH);
+            Token *token1 = new Token(0, i + 1, 0, player1Texture, cellW, cellH);
+            Token *token2 = new Token(i + 1, 0, 1, player2Texture, cellW, cellH);
 
             player1.addToken(token1);
             player2.addToken(token2);
@@ -30,14 +34,43 @@ private:
     }
 
 public:
-    GameState(float cellW, float cellH, size_t gameSize)
+    GameState(float cellW, float cellH, size_t gameSize,
+              const sf::Texture &player1Texture, const sf::Texture &player2Texture)
         : MaxTokensPerPlayer(gameSize - 2),
           board(gameSize, gameSize),
           player1(0, MaxTokensPerPlayer),
           player2(1, MaxTokensPerPlayer),
           currentPlayer(0)
     {
-        initializeTokens(cellW, cellH);
+        initializeTokens(cellW, cellH, player1Texture, player2Texture);
+    }
+
+    // Resume a saved game: tokens, flags, scores and turn come straight from the snapshot
+    GameState(float cellW, float cellH, const GameSnapshot &snapshot,
+              const sf::Texture &player1Texture, const sf::Texture &player2Texture)
+        : MaxTokensPerPlayer(snapshot.boardSize - 2),
+          board(snapshot.boardSize, snapshot.boardSize),
+          player1(0, MaxTokensPerPlayer),
+          player2(1, MaxTokensPerPlayer),
+          currentPlayer(snapshot.currentPlayer)
+    {
+        for (int player = 0; player < 2; ++player)
+        {
+            Player &owner = player == 0 ? player1 : player2;
+            for (const GameSnapshot::TokenRecord &record : snapshot.tokens[player])
+            {
+                Token *token = new Token(record.x, record.y, player,
+                                         player == 0 ? player1Texture : player2Texture, cellW, cellH);
+                // Flags first: addToken() and placeToken() only track tokens still in play
+                if (record.flags & GameSnapshot::ReachedEnd)
+                    token->tokenReachedEnd();
+                token->setMovable(record.flags & GameSnapshot::Movable);
+                owner.addToken(token);
+                board.placeToken(token);
+            }
+            owner.setScore(snapshot.scores[player]);
+            owner.updateMovableTokens();
+        }
     }
 
     // Delete copy operations
@@ -48,24 +81,98 @@ public:
     Player &getOtherPlayer() { return currentPlayer == 0 ? player2 : player1; }
     GameBoard &getBoard() { return board; }
 
+    // Everything needed to resume this game later
+    GameSnapshot toSnapshot(const std::string &player1Name, const std::string &player2Name) const
+    {
+        GameSnapshot snapshot;
+        snapshot.boardSize = MaxTokensPerPlayer + 2;
+        snapshot.currentPlayer = currentPlayer;
+        snapshot.names[0] = player1Name;
+        snapshot.names[1] = player2Name;
+        for (int player = 0; player < 2; ++player)
+        {
+            const Player &owner = player == 0 ? player1 : player2;
+            snapshot.scores[player] = owner.getScore();
+            for (const Token *token : owner.getTokens())
+            {
+                const auto [x, y] = token->getPosition();
+                const uint8_t flags = (token->isMovable() ? GameSnapshot::Movable : 0) |
+                                      (token->hasReachedEnd() ? GameSnapshot::ReachedEnd : 0);
+                snapshot.tokens[player].push_back({static_cast<uint8_t>(x), static_cast<uint8_t>(y), flags});
+            }
+        }
+        return snapshot;
+    }
+
+    // Snapshot of the current position for analysis
+    Position toPosition() const
+    {
+        return Position(board.getGrid(), currentPlayer);
+    }
+
     void switchPlayer()
     {
         currentPlayer = 1 - currentPlayer;
     }
 
-    void moveToken(int fromX, int fromY, int toX, int toY)
+    // Apply a move and update mobility and scores; nothing changes on failure
+    MoveStatus tryMoveToken(int fromX, int fromY, int toX, int toY) noexcept
     {
-        board.moveToken(fromX, fromY, toX, toY);
-        player1.updateMovableTokens();
-        player2.updateMovableTokens();
+        const MoveResult result = board.tryMoveToken(fromX, fromY, toX, toY);
+        if (!result.ok())
+            return result.status;
 
-        if (auto token = board.getTokenAt(toX, toY))
+        // Retired tokens can never move again, so only a token that just moved can have just scored
+        if (auto token = board.getTokenAt(result.x, result.y))
         {
             if (token->hasReachedEnd())
             {
+                (token->getPlayer() == 0 ? player1 : player2).retireToken(token);
                 getCurrentPlayer().setScore(getCurrentPlayer().getScore() + 1);
             }
         }
+
+        // The board already counted movable tokens while refreshing their flags
+        player1.setMovableTokens(board.getMovableCount(0));
+        player2.setMovableTokens(board.getMovableCount(1));
+        return MoveStatus::Ok;
+    }
+
+    void moveToken(int fromX, int fromY, int toX, int toY)
+    {
+        GameBoard::throwMoveError(tryMoveToken(fromX, fromY, toX, toY));
+    }
+
+    /**
+     * Replay moves the way the game plays them, in one pass over the
+     * board (see GameBoard::applyMoves()) instead of a full mobility
+     * refresh per move. Scores, retired tokens, movable counts and the
+     * player to move are brought up to date once at the end. On failure
+     * the moves before moves[result.applied] stay applied.
+     */
+    GameBoard::BatchResult applyMoves(const Move *moves, size_t count) noexcept
+    {
+        const GameBoard::BatchResult result = board.applyMoves(moves, count, currentPlayer);
+        for (int player = 0; player < 2; ++player)
+        {
+            Player &owner = player == 0 ? player1 : player2;
+            if (result.scored[player] != 0)
+            {
+                // retireToken() swaps the last active token into the freed slot
+                const std::vector<Token *> &active = owner.getActiveTokens();
+                for (size_t i = 0; i < active.size();)
+                {
+                    if (active[i]->hasReachedEnd())
+                        owner.retireToken(active[i]);
+                    else
+                        ++i;
+                }
+                owner.setScore(owner.getScore() + result.scored[player]);
+            }
+            owner.setMovableTokens(board.getMovableCount(player));
+        }
+        currentPlayer = result.player;
+        return result;
     }
 };
 
@@ -0,0 +1,985 @@
+#ifndef GAMESERVER_H
+#define GAMESERVER_H
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "GameProtocol.h"
+#include "GameSnapshot.h"
+#include "LineSocket.h"
+#include "MemoryBudget.h"
+#include "Search.h"
+
+/**
+ * Headless server holding many games in one process (Linux only).
+ *
+ * One thread runs an epoll loop over the TCP and Unix listeners and every
+ * client connection: it parses frames, queues requests per session and
+ * writes replies. Moves and analysis run on a worker pool, one request
+ * per session at a time so each session is only ever touched by one
+ * thread and needs no lock. Finished work comes back through a queue and
+ * an eventfd that wakes the loop.
+ *
+ * Sessions hold a Position, the same rules the tools and search use, so a
+ * game costs a few hundred bytes plus its latency histogram. Latency is
+ * measured from a request's arrival to its reply being queued, per session
+ * and for the whole server.
+ *
+ * With a memory limit the search tables, sessions and connection buffers
+ * each get a share of it. Tables are sized to fit; when sessions run out
+ * of room the longest idle ones are closed, and only if none has been
+ * idle long enough is a new game refused. Connections that hold more than
+ * their share of buffered output stop being read until it drains.
+ */
+class GameServer
+{
+public:
+    using MessageType = GameProtocol::MessageType;
+    using ErrorCode = GameProtocol::ErrorCode;
+    using LatencyHistogram = GameProtocol::LatencyHistogram;
+
+    struct Options
+    {
+        uint16_t port = 7411;        // 0 disables TCP
+        std::string address = "127.0.0.1"; // TCP bind address; the protocol has no authentication
+        std::string unixPath;        // Empty disables the Unix socket
+        unsigned threads = 1;        // Worker threads
+        size_t tableMegabytes = 16;  // Search table per worker
+        uint64_t searchNodes = 200000; // Node limit of every server search
+        int maxDepth = 16;
+        size_t maxSessions = 1000000;
+        size_t maxPendingOutput = 4 << 20; // Stop reading a connection that does not drain its replies
+        size_t memoryMegabytes = 0;  // Limit for tables, sessions and buffers together; 0 for none
+        double minIdleSeconds = 30;  // Sessions idle this long may be closed to make room
+    };
+
+    struct Stats
+    {
+        double seconds;
+        size_t sessions;
+        size_t connections;
+        uint64_t requests;
+        uint64_t intervalRequests;
+        LatencyHistogram intervalLatency;
+        std::vector<MemoryBudget::Usage> memory;
+    };
+
+    struct Report
+    {
+        double seconds = 0;
+        uint64_t requests = 0;
+        uint64_t sessionsCreated = 0;
+        uint64_t sessionsEvicted = 0; // Idle sessions closed for memory
+        size_t peakSessions = 0;
+        size_t peakConnections = 0;
+        LatencyHistogram latency;
+        std::vector<MemoryBudget::Usage> memory; // Peaks over the whole run
+    };
+
+    using StatsCallback = std::function<void(const Stats &)>;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // epoll ids below FirstConnection are not connections
+    enum : uint64_t
+    {
+        TcpListener = 1,
+        UnixListener = 2,
+        Wakeup = 3,
+        FirstConnection = 16
+    };
+
+    // Split of the memory limit
+    static constexpr double TableShare = 0.4;
+    static constexpr double SessionShare = 0.45;
+    static constexpr double BufferShare = 0.15;
+    static constexpr size_t SessionOverhead = 64;   // Map node and subscriber list
+    static constexpr size_t IdleBufferBytes = 65536; // Larger drained buffers are freed under a limit
+    static constexpr size_t EvictFraction = 64;      // Close up to 1/64 of the sessions per eviction
+
+    struct Request
+    {
+        MessageType type;
+        uint64_t connection;
+        uint32_t session;
+        uint8_t args[4]; // Move coordinates, or the depth of an analysis
+        Clock::time_point received;
+    };
+
+    struct Session
+    {
+        uint32_t id;
+        Position position;
+        uint8_t computers;
+        uint8_t depth;
+        bool busy = false;    // A worker owns the session
+        bool closing = false; // Nobody is attached; drop once the worker is done
+        std::vector<uint64_t> subscribers;
+        std::vector<Request> queue;
+        size_t queueHead = 0;
+        LatencyHistogram latency;
+        Clock::time_point lastActive = Clock::now();
+        size_t charged = 0; // Bytes held in the session account
+
+        Session(uint32_t sessionId, size_t size, uint8_t computerMask, uint8_t searchDepth)
+            : id(sessionId), position(size), computers(computerMask), depth(searchDepth) {}
+
+        bool computerToMove() const
+        {
+            return !position.isGameOver() && ((computers >> position.getSideToMove()) & 1);
+        }
+    };
+
+    struct Connection
+    {
+        int fd;
+        std::string input;
+        std::string output;
+        size_t outputSent = 0;
+        uint32_t events = 0; // Registered epoll interest
+        size_t charged = 0;  // Buffer capacity held in the buffer account
+        std::vector<uint32_t> sessions;
+    };
+
+    // Work handed back to the loop; reply goes to the requester, broadcast to every subscriber
+    struct Completion
+    {
+        Session *session;
+        Request request;
+        std::string reply;
+        std::string broadcast;
+    };
+
+    Options options;
+    MemoryBudget budget;
+    MemoryBudget::Account &tableMemory;
+    MemoryBudget::Account &sessionMemory;
+    MemoryBudget::Account &bufferMemory;
+    size_t workerTableBytes = 0;
+    Clock::time_point nextEvictionScan;
+
+    int epollFd = -1;
+    int tcpFd = -1;
+    int unixFd = -1;
+    int wakeFd = -1;
+    std::atomic<bool> stopRequested{false};
+
+    std::unordered_map<uint64_t, Connection> connections;
+    std::unordered_map<uint32_t, std::unique_ptr<Session>> sessions;
+    std::vector<uint64_t> dirty; // Connections with output to flush
+    uint64_t nextConnection = FirstConnection;
+    uint32_t nextSession = 1;
+
+    // Worker pool
+    std::vector<std::thread> workers;
+    std::mutex jobMutex;
+    std::condition_variable jobReady;
+    std::deque<std::pair<Session *, Request>> jobs;
+    std::vector<std::pair<Session *, Request>> submitting; // Handed over once per loop iteration
+    bool quitWorkers = false;
+    std::mutex doneMutex;
+    std::vector<Completion> done;
+
+    Report report;
+    LatencyHistogram intervalLatency;
+    uint64_t intervalRequests = 0;
+
+    static void setNonBlocking(int fd)
+    {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    }
+
+    static int listenUnix(const std::string &path)
+    {
+        sockaddr_un address{};
+        if (path.size() >= sizeof(address.sun_path))
+            throw std::runtime_error("Unix socket path too long: " + path);
+        address.sun_family = AF_UNIX;
+        std::strcpy(address.sun_path, path.c_str());
+
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+            throw std::runtime_error("Cannot create Unix socket");
+        unlink(path.c_str());
+        if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(fd, 4096) != 0)
+        {
+            close(fd);
+            throw std::runtime_error("Cannot listen on " + path);
+        }
+        return fd;
+    }
+
+    void watch(int fd, uint64_t id, uint32_t events, int operation = EPOLL_CTL_ADD)
+    {
+        epoll_event event{};
+        event.events = events;
+        event.data.u64 = id;
+        epoll_ctl(epollFd, operation, fd, &event);
+    }
+
+    // Pending output past which a connection is not read; under a limit, its share of the buffer memory
+    size_t outputLimit() const
+    {
+        if (bufferMemory.getLimit() == 0)
+            return options.maxPendingOutput;
+        const size_t share = bufferMemory.getLimit() / std::max<size_t>(connections.size(), 1);
+        return std::min(options.maxPendingOutput, std::max(share, IdleBufferBytes));
+    }
+
+    // Read while the client keeps up with its replies; wait for writability while output is pending
+    void updateInterest(uint64_t id, Connection &connection)
+    {
+        const size_t pending = connection.output.size() - connection.outputSent;
+        const uint32_t events = (pending < outputLimit() ? uint32_t(EPOLLIN) : 0u) | (pending ? uint32_t(EPOLLOUT) : 0u);
+        if (events != connection.events)
+        {
+            connection.events = events;
+            watch(connection.fd, id, events, EPOLL_CTL_MOD);
+        }
+    }
+
+    // Charge what the connection's buffers hold now, freeing large drained ones under a limit
+    void accountBuffers(Connection &connection)
+    {
+        if (bufferMemory.getLimit() != 0)
+        {
+            if (connection.input.empty() && connection.input.capacity() > IdleBufferBytes)
+                std::string().swap(connection.input);
+            if (connection.output.empty() && connection.output.capacity() > IdleBufferBytes)
+                std::string().swap(connection.output);
+        }
+        const size_t bytes = connection.input.capacity() + connection.output.capacity();
+        if (bytes > connection.charged)
+            bufferMemory.charge(bytes - connection.charged);
+        else
+            bufferMemory.release(connection.charged - bytes);
+        connection.charged = bytes;
+    }
+
+    // Output buffer of a live connection, or null if it has gone away
+    std::string *outputOf(uint64_t id)
+    {
+        auto it = connections.find(id);
+        if (it == connections.end())
+            return nullptr;
+        dirty.push_back(id);
+        return &it->second.output;
+    }
+
+    void sendError(uint64_t connection, uint32_t session, MessageType request, ErrorCode code)
+    {
+        if (std::string *out = outputOf(connection))
+            GameProtocol::FrameWriter(*out, MessageType::Error).u32(session).u8(static_cast<uint8_t>(request)).u8(static_cast<uint8_t>(code));
+    }
+
+    void recordLatency(Session &session, const Request &request)
+    {
+        const uint64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - request.received).count();
+        session.latency.record(micros);
+        intervalLatency.record(micros);
+        report.latency.record(micros);
+    }
+
+    void acceptAll(int listener, bool tcp)
+    {
+        while (true)
+        {
+            const int fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0)
+                return;
+            if (tcp)
+            {
+                const int noDelay = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+            }
+            const uint64_t id = nextConnection++;
+            Connection &connection = connections[id];
+            connection.fd = fd;
+            connection.events = EPOLLIN;
+            watch(fd, id, EPOLLIN);
+            report.peakConnections = std::max(report.peakConnections, connections.size());
+        }
+    }
+
+    void closeConnection(uint64_t id)
+    {
+        auto it = connections.find(id);
+        if (it == connections.end())
+            return;
+        for (uint32_t sessionId : it->second.sessions)
+        {
+            auto found = sessions.find(sessionId);
+            if (found == sessions.end())
+                continue;
+            Session &session = *found->second;
+            session.subscribers.erase(std::remove(session.subscribers.begin(), session.subscribers.end(), id),
+                                      session.subscribers.end());
+            if (session.subscribers.empty())
+            {
+                session.closing = true;
+                if (!session.busy)
+                    dropSession(session);
+            }
+        }
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, it->second.fd, nullptr);
+        close(it->second.fd);
+        bufferMemory.release(it->second.charged);
+        connections.erase(it);
+    }
+
+    void subscribe(Session &session, uint64_t id)
+    {
+        if (std::find(session.subscribers.begin(), session.subscribers.end(), id) != session.subscribers.end())
+            return;
+        session.subscribers.push_back(id);
+        connections[id].sessions.push_back(session.id);
+    }
+
+    void removeSession(Session &session)
+    {
+        for (uint64_t id : session.subscribers)
+        {
+            auto it = connections.find(id);
+            if (it == connections.end())
+                continue;
+            std::vector<uint32_t> &owned = it->second.sessions;
+            owned.erase(std::remove(owned.begin(), owned.end(), session.id), owned.end());
+        }
+        dropSession(session);
+    }
+
+    // Requests still queued are refused, so clients that sent them do not wait forever
+    void dropSession(Session &session)
+    {
+        for (size_t i = session.queueHead; i < session.queue.size(); ++i)
+            sendError(session.queue[i].connection, session.id, session.queue[i].type, ErrorCode::UnknownSession);
+        sessionMemory.release(session.charged);
+        sessions.erase(session.id);
+    }
+
+    /**
+     * Close the longest idle sessions to make room for new ones. Returns
+     * false if none has been idle for minIdleSeconds; the next scan then
+     * waits a second so a full server does not scan on every Create.
+     */
+    bool evictIdle()
+    {
+        const Clock::time_point now = Clock::now();
+        if (now < nextEvictionScan)
+            return false;
+        const auto cutoff = now - std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.minIdleSeconds));
+        std::vector<std::pair<Clock::time_point, uint32_t>> idle;
+        for (const auto &[id, session] : sessions)
+        {
+            if (!session->busy && !session->closing && session->queue.empty() && session->lastActive <= cutoff)
+                idle.emplace_back(session->lastActive, id);
+        }
+        if (idle.empty())
+        {
+            nextEvictionScan = now + std::chrono::seconds(1);
+            return false;
+        }
+
+        const size_t count = std::max<size_t>(sessions.size() / EvictFraction, 1);
+        if (idle.size() > count)
+        {
+            std::nth_element(idle.begin(), idle.begin() + count, idle.end());
+            idle.resize(count);
+        }
+        for (const auto &entry : idle)
+        {
+            Session &session = *sessions[entry.second];
+            for (uint64_t id : session.subscribers)
+            {
+                if (std::string *out = outputOf(id))
+                    GameProtocol::FrameWriter(*out, MessageType::Closed).u32(session.id);
+            }
+            removeSession(session);
+        }
+        report.sessionsEvicted += idle.size();
+        return true;
+    }
+
+    void enqueue(Session &session, const Request &request)
+    {
+        session.lastActive = request.received;
+        session.queue.push_back(request);
+        pump(session);
+    }
+
+    // Start the session's next request: cheap ones right here, moves and analysis on a worker
+    void pump(Session &session)
+    {
+        while (!session.busy && session.queueHead < session.queue.size())
+        {
+            const Request request = session.queue[session.queueHead++];
+            if (session.queueHead == session.queue.size())
+            {
+                session.queue.clear();
+                session.queueHead = 0;
+            }
+
+            switch (request.type)
+            {
+            case MessageType::Create:
+            case MessageType::Move:
+            case MessageType::Analyze:
+                session.busy = true;
+                submitting.emplace_back(&session, request);
+                return;
+
+            case MessageType::Join:
+            case MessageType::State:
+                if (std::string *out = outputOf(request.connection))
+                {
+                    const std::string snapshot = GameSnapshot::fromPosition(session.position).encode();
+                    GameProtocol::FrameWriter(*out, MessageType::Snapshot).u32(session.id).bytes(snapshot);
+                }
+                recordLatency(session, request);
+                break;
+
+            case MessageType::Latency:
+                recordLatency(session, request);
+                if (std::string *out = outputOf(request.connection))
+                {
+                    GameProtocol::FrameWriter frame(*out, MessageType::LatencyReport);
+                    session.latency.write(frame.u32(session.id));
+                }
+                break;
+
+            case MessageType::Close:
+                for (uint64_t id : session.subscribers)
+                {
+                    if (std::string *out = outputOf(id))
+                        GameProtocol::FrameWriter(*out, MessageType::Closed).u32(session.id);
+                }
+                removeSession(session);
+                return;
+
+            default:
+                break;
+            }
+        }
+    }
+
+    void handleFrame(uint64_t id, MessageType type, GameProtocol::FrameReader &fields)
+    {
+        ++report.requests;
+        ++intervalRequests;
+        Request request{type, id, 0, {0, 0, 0, 0}, Clock::now()};
+
+        if (type == MessageType::Create)
+        {
+            const uint32_t tag = fields.u32();
+            const uint8_t size = fields.u8();
+            const uint8_t computers = fields.u8();
+            const uint8_t depth = fields.u8();
+            if (!fields.ok() || size < 3 || size - 2 > Position::MaxMoves || computers > 3 ||
+                depth < 1 || depth > options.maxDepth)
+            {
+                sendError(id, tag, type, ErrorCode::BadRequest);
+                return;
+            }
+            while (sessions.count(nextSession) || nextSession == 0)
+                ++nextSession;
+            auto created = std::make_unique<Session>(nextSession, size, computers, depth);
+            created->charged = sizeof(Session) + created->position.getHeapBytes() + SessionOverhead;
+            if (sessions.size() >= options.maxSessions ||
+                (!sessionMemory.tryCharge(created->charged) && !(evictIdle() && sessionMemory.tryCharge(created->charged))))
+            {
+                sendError(id, tag, type, ErrorCode::ServerFull);
+                return;
+            }
+
+            const uint32_t sessionId = nextSession++;
+            Session &session = *(sessions[sessionId] = std::move(created));
+            ++report.sessionsCreated;
+            report.peakSessions = std::max(report.peakSessions, sessions.size());
+            subscribe(session, id);
+            if (std::string *out = outputOf(id))
+                GameProtocol::FrameWriter(*out, MessageType::Created).u32(tag).u32(sessionId);
+            // A Create job lets the server open the game when it plays the first player; its
+            // latency is then recorded once, when the job completes
+            if (session.computerToMove())
+                enqueue(session, request);
+            else
+                recordLatency(session, request);
+            return;
+        }
+
+        request.session = fields.u32();
+        if (type == MessageType::Latency && request.session == 0 && fields.ok())
+        {
+            if (std::string *out = outputOf(id))
+            {
+                GameProtocol::FrameWriter frame(*out, MessageType::LatencyReport);
+                report.latency.write(frame.u32(0));
+            }
+            return;
+        }
+
+        const bool hasSession = type == MessageType::Join || type == MessageType::Move || type == MessageType::State ||
+                                type == MessageType::Analyze || type == MessageType::Latency || type == MessageType::Close;
+        if (type == MessageType::Move)
+        {
+            for (uint8_t &arg : request.args)
+                arg = fields.u8();
+        }
+        else if (type == MessageType::Analyze)
+        {
+            request.args[0] = fields.u8();
+        }
+        if (!hasSession || !fields.ok() || !fields.atEnd())
+        {
+            sendError(id, request.session, type, ErrorCode::BadRequest);
+            return;
+        }
+
+        auto found = sessions.find(request.session);
+        if (found == sessions.end() || found->second->closing)
+        {
+            sendError(id, request.session, type, ErrorCode::UnknownSession);
+            return;
+        }
+        if (type == MessageType::Join)
+            subscribe(*found->second, id);
+        enqueue(*found->second, request);
+    }
+
+    void readConnection(uint64_t id)
+    {
+        auto it = connections.find(id);
+        if (it == connections.end())
+            return; // Closed earlier in this batch of events
+        Connection &connection = it->second;
+        char chunk[65536];
+        for (int reads = 0; reads < 4; ++reads)
+        {
+            const ssize_t count = recv(connection.fd, chunk, sizeof(chunk), 0);
+            if (count == 0 || (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+            {
+                closeConnection(id);
+                return;
+            }
+            if (count < 0)
+                break;
+            connection.input.append(chunk, static_cast<size_t>(count));
+            if (static_cast<size_t>(count) < sizeof(chunk))
+                break;
+        }
+
+        size_t offset = 0;
+        GameProtocol::MessageType type;
+        GameProtocol::FrameReader fields(nullptr, 0);
+        while (GameProtocol::nextFrame(connection.input, offset, type, fields))
+        {
+            handleFrame(id, type, fields);
+            if (!connections.count(id))
+                return;
+        }
+        connection.input.erase(0, offset);
+        accountBuffers(connection);
+    }
+
+    void flush(uint64_t id)
+    {
+        auto it = connections.find(id);
+        if (it == connections.end())
+            return;
+        Connection &connection = it->second;
+        while (connection.outputSent < connection.output.size())
+        {
+            const ssize_t count = send(connection.fd, connection.output.data() + connection.outputSent,
+                                       connection.output.size() - connection.outputSent, MSG_NOSIGNAL);
+            if (count < 0)
+            {
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+                    break;
+                closeConnection(id);
+                return;
+            }
+            connection.outputSent += static_cast<size_t>(count);
+        }
+        if (connection.outputSent == connection.output.size())
+        {
+            connection.output.clear();
+            connection.outputSent = 0;
+        }
+        accountBuffers(connection);
+        updateInterest(id, connection);
+    }
+
+    static void appendMoved(std::string &out, const Session &session, const Move &move)
+    {
+        const Position &pos = session.position;
+        const BoardGrid &grid = pos.getGrid();
+        GameProtocol::FrameWriter(out, MessageType::Moved)
+            .u32(session.id)
+            .u8(grid.column(move.from))
+            .u8(grid.row(move.from))
+            .u8(grid.column(move.to))
+            .u8(grid.row(move.to))
+            .u8(pos.getSideToMove())
+            .u8(pos.getScore(0))
+            .u8(pos.getScore(1))
+            .u8(static_cast<uint8_t>(GameProtocol::statusOf(pos)));
+    }
+
+    // Why a requested move is not a legal move of the side to move
+    static ErrorCode moveError(const Position &pos, const uint8_t *args)
+    {
+        const BoardGrid &grid = pos.getGrid();
+        if (!grid.isValidPosition(args[0], args[1]) || !grid.isValidPosition(args[2], args[3]))
+            return ErrorCode::OutOfBounds;
+        const size_t from = grid.index(args[0], args[1]);
+        if (!grid.isOccupied(from) || BoardGrid::cellPlayer(grid.at(from)) != pos.getSideToMove())
+            return ErrorCode::NoToken;
+        if (!grid.canMove(from))
+            return ErrorCode::Immovable;
+        return ErrorCode::IllegalMove;
+    }
+
+    Search::Limits searchLimits(int depth) const
+    {
+        Search::Limits limits;
+        limits.depth = depth;
+        limits.nodes = options.searchNodes;
+        limits.stop = &stopRequested;
+        return limits;
+    }
+
+    // Let the server play while it is on move
+    void playComputer(Search &search, Session &session, std::string &broadcast)
+    {
+        while (session.computerToMove() && !stopRequested)
+        {
+            const Search::Info info = search.run(session.position, searchLimits(session.depth));
+            if (!info.hasMove)
+                return;
+            session.position.makeMove(info.bestMove);
+            appendMoved(broadcast, session, info.bestMove);
+        }
+    }
+
+    // Runs on a worker thread, which owns the session until the completion is handled
+    Completion execute(Search &search, Session &session, const Request &request)
+    {
+        Completion completion{&session, request, {}, {}};
+        Position &pos = session.position;
+        auto fail = [&](ErrorCode code)
+        {
+            GameProtocol::FrameWriter(completion.reply, MessageType::Error).u32(session.id).u8(static_cast<uint8_t>(request.type)).u8(static_cast<uint8_t>(code));
+        };
+
+        switch (request.type)
+        {
+        case MessageType::Create:
+            playComputer(search, session, completion.broadcast);
+            break;
+
+        case MessageType::Move:
+        {
+            Move move;
+            if (pos.isGameOver())
+                fail(ErrorCode::GameOver);
+            else if (session.computerToMove())
+                fail(ErrorCode::ComputerTurn);
+            else if (!pos.findMove(request.args[0], request.args[1], request.args[2], request.args[3], move))
+                fail(moveError(pos, request.args));
+            else
+            {
+                pos.makeMove(move);
+                appendMoved(completion.broadcast, session, move);
+                playComputer(search, session, completion.broadcast);
+            }
+            break;
+        }
+
+        case MessageType::Analyze:
+        {
+            const int depth = std::clamp<int>(request.args[0], 1, options.maxDepth);
+            const Search::Info info = pos.isGameOver() ? Search::Info{} : search.run(pos, searchLimits(depth));
+            const BoardGrid &grid = pos.getGrid();
+            const uint8_t none = GameProtocol::NoSquare;
+            GameProtocol::FrameWriter(completion.reply, MessageType::Analysis)
+                .u32(session.id)
+                .u8(info.hasMove ? grid.column(info.bestMove.from) : none)
+                .u8(info.hasMove ? grid.row(info.bestMove.from) : none)
+                .u8(info.hasMove ? grid.column(info.bestMove.to) : none)
+                .u8(info.hasMove ? grid.row(info.bestMove.to) : none)
+                .i32(info.score)
+                .u8(static_cast<uint8_t>(info.depth));
+            break;
+        }
+
+        default:
+            break;
+        }
+        return completion;
+    }
+
+    void workerLoop()
+    {
+        Search search(0);
+        search.resizeBytes(workerTableBytes);
+        tableMemory.charge(search.getTableBytes());
+        std::unique_lock<std::mutex> lock(jobMutex);
+        while (true)
+        {
+            jobReady.wait(lock, [&]
+                          { return quitWorkers || !jobs.empty(); });
+            if (quitWorkers)
+            {
+                tableMemory.release(search.getTableBytes());
+                return;
+            }
+            const auto [session, request] = jobs.front();
+            jobs.pop_front();
+            lock.unlock();
+
+            Completion completion = execute(search, *session, request);
+            bool wake;
+            {
+                std::lock_guard<std::mutex> doneLock(doneMutex);
+                wake = done.empty();
+                done.push_back(std::move(completion));
+            }
+            if (wake)
+            {
+                const uint64_t one = 1;
+                (void)!write(wakeFd, &one, sizeof(one));
+            }
+            lock.lock();
+        }
+    }
+
+    // One lock and wakeup for all the work a loop iteration produced
+    void submitJobs()
+    {
+        if (submitting.empty())
+            return;
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            jobs.insert(jobs.end(), submitting.begin(), submitting.end());
+        }
+        if (submitting.size() >= workers.size())
+            jobReady.notify_all();
+        else
+        {
+            for (size_t i = 0; i < submitting.size(); ++i)
+                jobReady.notify_one();
+        }
+        submitting.clear();
+    }
+
+    void handleCompletions()
+    {
+        uint64_t count;
+        (void)!read(wakeFd, &count, sizeof(count));
+        std::vector<Completion> finished;
+        {
+            std::lock_guard<std::mutex> lock(doneMutex);
+            finished.swap(done);
+        }
+
+        for (Completion &completion : finished)
+        {
+            Session &session = *completion.session;
+            session.busy = false;
+            if (!completion.reply.empty())
+            {
+                if (std::string *out = outputOf(completion.request.connection))
+                    *out += completion.reply;
+            }
+            if (!completion.broadcast.empty())
+            {
+                for (uint64_t id : session.subscribers)
+                {
+                    if (std::string *out = outputOf(id))
+                        *out += completion.broadcast;
+                }
+            }
+            recordLatency(session, completion.request);
+
+            if (session.closing)
+                dropSession(session);
+            else
+                pump(session);
+        }
+    }
+
+    void shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            quitWorkers = true;
+        }
+        jobReady.notify_all();
+        for (std::thread &worker : workers)
+            worker.join();
+        workers.clear();
+
+        for (auto &[id, connection] : connections)
+        {
+            close(connection.fd);
+            bufferMemory.release(connection.charged);
+        }
+        connections.clear();
+        for (const auto &entry : sessions)
+            sessionMemory.release(entry.second->charged);
+        sessions.clear();
+        for (int fd : {tcpFd, unixFd, wakeFd, epollFd})
+        {
+            if (fd >= 0)
+                close(fd);
+        }
+        if (unixFd >= 0)
+            unlink(options.unixPath.c_str());
+        tcpFd = unixFd = wakeFd = epollFd = -1;
+    }
+
+public:
+    explicit GameServer(const Options &serverOptions)
+        : options(serverOptions), budget(serverOptions.memoryMegabytes * 1024 * 1024),
+          tableMemory(budget.add("tables", TableShare)), sessionMemory(budget.add("sessions", SessionShare)),
+          bufferMemory(budget.add("buffers", BufferShare)) {}
+
+    ~GameServer()
+    {
+        if (epollFd >= 0)
+            shutdown();
+    }
+
+    GameServer(const GameServer &) = delete;
+    GameServer &operator=(const GameServer &) = delete;
+
+    // Safe to call from a signal handler
+    void stop()
+    {
+        stopRequested = true;
+        if (wakeFd >= 0)
+        {
+            const uint64_t one = 1;
+            (void)!write(wakeFd, &one, sizeof(one));
+        }
+    }
+
+    // Serve until stop(); stats are reported every interval seconds
+    Report run(const StatsCallback &callback = nullptr, double interval = 5.0)
+    {
+        const auto startTime = Clock::now();
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epollFd < 0 || wakeFd < 0)
+            throw std::runtime_error("Cannot create epoll instance");
+        watch(wakeFd, Wakeup, EPOLLIN);
+
+        try
+        {
+            if (options.port)
+            {
+                tcpFd = LineSocket::listenOn(options.port, options.address, 4096);
+                setNonBlocking(tcpFd);
+                watch(tcpFd, TcpListener, EPOLLIN);
+            }
+            if (!options.unixPath.empty())
+            {
+                unixFd = listenUnix(options.unixPath);
+                setNonBlocking(unixFd);
+                watch(unixFd, UnixListener, EPOLLIN);
+            }
+        }
+        catch (...)
+        {
+            shutdown();
+            throw;
+        }
+
+        const unsigned threads = std::max(options.threads, 1u);
+        workerTableBytes = options.tableMegabytes * 1024 * 1024;
+        if (tableMemory.getLimit() != 0)
+            workerTableBytes = std::min(workerTableBytes, tableMemory.getLimit() / threads);
+        for (unsigned i = 0; i < threads; ++i)
+            workers.emplace_back(&GameServer::workerLoop, this);
+
+        auto nextStats = startTime + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(interval));
+        std::vector<epoll_event> events(1024);
+        while (!stopRequested)
+        {
+            const int timeout = static_cast<int>(std::max<int64_t>(
+                0, std::chrono::duration_cast<std::chrono::milliseconds>(nextStats - Clock::now()).count()));
+            const int count = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), timeout);
+            if (count < 0 && errno != EINTR)
+                break;
+
+            for (int i = 0; i < count; ++i)
+            {
+                const uint64_t id = events[i].data.u64;
+                if (id == TcpListener)
+                    acceptAll(tcpFd, true);
+                else if (id == UnixListener)
+                    acceptAll(unixFd, false);
+                else if (id == Wakeup)
+                    handleCompletions();
+                else
+                {
+                    if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+                        readConnection(id);
+                    if (events[i].events & EPOLLOUT)
+                        dirty.push_back(id);
+                }
+            }
+
+            submitJobs();
+
+            // Write replies straight away; only what the socket refuses waits for EPOLLOUT
+            std::vector<uint64_t> flushing;
+            flushing.swap(dirty);
+            std::sort(flushing.begin(), flushing.end());
+            flushing.erase(std::unique(flushing.begin(), flushing.end()), flushing.end());
+            for (uint64_t id : flushing)
+                flush(id);
+
+            if (Clock::now() >= nextStats)
+            {
+                if (callback)
+                {
+                    Stats stats{std::chrono::duration<double>(Clock::now() - startTime).count(), sessions.size(),
+                                connections.size(), report.requests, intervalRequests, intervalLatency, budget.usage()};
+                    callback(stats);
+                }
+                intervalRequests = 0;
+                intervalLatency.clear();
+                nextStats += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(interval));
+            }
+        }
+
+        shutdown();
+        report.seconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+        report.memory = budget.usage();
+        return report;
+    }
+};
+
+#endif // GAMESERVER_H
@@ -0,0 +1,203 @@
+#ifndef GAMESNAPSHOT_H
+#define GAMESNAPSHOT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "ChecksummedFile.h"
+#include "Position.h"
+
+/**
+ * Everything needed to resume a game, in a compact checksummed format.
+ *
+ * Layout (all fields single bytes unless noted):
+ *
+ *   "GTSS" version size current score0 score1 nameLen0 nameLen1
+ *   name0 name1
+ *   per player, size - 2 tokens of x y flags (in the player's token order)
+ *   FNV-1a of all preceding bytes (8 bytes, little endian)
+ *
+ * A 51x51 game fits in well under a kilobyte and loads with a single read.
+ * The tools accept the same files wherever they take a position.
+ */
+struct GameSnapshot
+{
+    static constexpr char Magic[4] = {'G', 'T', 'S', 'S'};
+    static constexpr uint8_t Version = 1;
+    static constexpr size_t HeaderSize = 11;
+    static constexpr size_t ChecksumSize = ChecksummedFile::ChecksumSize;
+
+    enum TokenFlags : uint8_t
+    {
+        Movable = 1,
+        ReachedEnd = 2
+    };
+
+    struct TokenRecord
+    {
+        uint8_t x;
+        uint8_t y;
+        uint8_t flags;
+    };
+
+    size_t boardSize = 0;
+    int currentPlayer = 0;
+    int scores[2] = {0, 0};
+    std::string names[2] = {"Player 1", "Player 2"};
+    std::vector<TokenRecord> tokens[2];
+
+    // Flags a token at idx must carry; only the far edge counts as reached
+    static uint8_t expectedFlags(const BoardGrid &grid, size_t idx, int player)
+    {
+        const size_t last = grid.getWidth() - 1;
+        const bool reached = static_cast<size_t>(player == 0 ? grid.column(idx) : grid.row(idx)) == last;
+        return (grid.canMove(idx) ? Movable : 0) | (reached ? ReachedEnd : 0);
+    }
+
+    // Snapshot of an analysis position; flags and scores follow from the board
+    static GameSnapshot fromPosition(const Position &pos)
+    {
+        GameSnapshot snapshot;
+        const BoardGrid &grid = pos.getGrid();
+        snapshot.boardSize = grid.getWidth();
+        snapshot.currentPlayer = pos.getSideToMove();
+        for (int player = 0; player < 2; ++player)
+        {
+            snapshot.scores[player] = pos.getScore(player);
+            for (uint16_t idx : pos.getTokens(player))
+            {
+                snapshot.tokens[player].push_back({static_cast<uint8_t>(grid.column(idx)),
+                                                   static_cast<uint8_t>(grid.row(idx)),
+                                                   expectedFlags(grid, idx, player)});
+            }
+        }
+        return snapshot;
+    }
+
+    // Board occupancy; throws if a token lies outside the board or on another token
+    BoardGrid toGrid() const
+    {
+        BoardGrid grid(boardSize, boardSize);
+        for (int player = 0; player < 2; ++player)
+        {
+            for (const TokenRecord &token : tokens[player])
+            {
+                if (!grid.isValidPosition(token.x, token.y))
+                    throw std::runtime_error("Snapshot token outside the board");
+                const size_t idx = grid.index(token.x, token.y);
+                if (!grid.isEmpty(idx))
+                    throw std::runtime_error("Snapshot tokens overlap");
+                grid.set(idx, BoardGrid::playerCell(player));
+            }
+        }
+        return grid;
+    }
+
+    Position toPosition() const
+    {
+        return Position(toGrid(), currentPlayer);
+    }
+
+    std::string encode() const
+    {
+        std::string bytes(Magic, sizeof(Magic));
+        bytes.reserve(HeaderSize + names[0].size() + names[1].size() +
+                      3 * (tokens[0].size() + tokens[1].size()) + ChecksumSize);
+        bytes += static_cast<char>(Version);
+        bytes += static_cast<char>(boardSize);
+        bytes += static_cast<char>(currentPlayer);
+        for (int player = 0; player < 2; ++player)
+            bytes += static_cast<char>(scores[player]);
+        for (int player = 0; player < 2; ++player)
+            bytes += static_cast<char>(std::min<size_t>(names[player].size(), 255));
+        for (int player = 0; player < 2; ++player)
+            bytes.append(names[player], 0, 255);
+        for (int player = 0; player < 2; ++player)
+        {
+            for (const TokenRecord &token : tokens[player])
+            {
+                bytes += static_cast<char>(token.x);
+                bytes += static_cast<char>(token.y);
+                bytes += static_cast<char>(token.flags);
+            }
+        }
+
+        ChecksummedFile::appendChecksum(bytes);
+        return bytes;
+    }
+
+    /**
+     * Parse and validate a snapshot. Besides the checksum, the tokens must
+     * form a legal board whose movable and reached-end flags and scores
+     * agree with it.
+     */
+    static GameSnapshot decode(const std::string &bytes)
+    {
+        const uint8_t *data = reinterpret_cast<const uint8_t *>(bytes.data());
+        if (bytes.size() < HeaderSize + ChecksumSize || bytes.compare(0, sizeof(Magic), Magic, sizeof(Magic)) != 0)
+            throw std::runtime_error("Not a game snapshot");
+        if (data[4] != Version)
+            throw std::runtime_error("Unsupported snapshot version");
+
+        const size_t body = ChecksummedFile::verifyChecksum(bytes, "Snapshot");
+
+        GameSnapshot snapshot;
+        snapshot.boardSize = data[5];
+        snapshot.currentPlayer = data[6];
+        snapshot.scores[0] = data[7];
+        snapshot.scores[1] = data[8];
+        if (snapshot.boardSize < 3 || snapshot.boardSize - 2 > Position::MaxMoves || snapshot.currentPlayer > 1)
+            throw std::runtime_error("Corrupt snapshot header");
+
+        const size_t tokensPerPlayer = snapshot.boardSize - 2;
+        if (body != HeaderSize + data[9] + data[10] + 2 * tokensPerPlayer * 3)
+            throw std::runtime_error("Snapshot has the wrong length");
+
+        size_t offset = HeaderSize;
+        for (int player = 0; player < 2; ++player)
+        {
+            snapshot.names[player].assign(bytes, offset, data[9 + player]);
+            offset += data[9 + player];
+        }
+        for (int player = 0; player < 2; ++player)
+        {
+            snapshot.tokens[player].resize(tokensPerPlayer);
+            for (TokenRecord &token : snapshot.tokens[player])
+            {
+                token = {data[offset], data[offset + 1], data[offset + 2]};
+                offset += 3;
+            }
+        }
+
+        // The flags are redundant with the board, which makes them a cheap consistency check
+        const BoardGrid grid = snapshot.toGrid();
+        for (int player = 0; player < 2; ++player)
+        {
+            int reached = 0;
+            for (const TokenRecord &token : snapshot.tokens[player])
+            {
+                if (token.flags != expectedFlags(grid, grid.index(token.x, token.y), player))
+                    throw std::runtime_error("Snapshot token flags disagree with the board");
+                reached += (token.flags & ReachedEnd) ? 1 : 0;
+            }
+            if (snapshot.scores[player] != reached)
+                throw std::runtime_error("Snapshot scores disagree with the board");
+        }
+        return snapshot;
+    }
+
+    // Replaces path atomically, so a crash never leaves half a snapshot
+    void save(const std::string &path) const
+    {
+        ChecksummedFile::write(path, encode());
+    }
+
+    static GameSnapshot load(const std::string &path)
+    {
+        return decode(ChecksummedFile::read(path));
+    }
+};
+
+#endif // GAMESNAPSHOT_H
@@ -0,0 +1,556 @@
+#ifndef GAMETREEVIEW_H
+#define GAMETREEVIEW_H
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Position.h"
+#include "Search.h"
+
+/**
+ * Window showing the tree of moves from the current game position.
+ *
+ * Nodes live in one flat vector and children are generated only when a
+ * node is first expanded. The rows currently on screen are kept as a
+ * flattened list of node indices; only the slice that fits the window is
+ * laid out and drawn, so expanding millions of nodes costs memory but not
+ * frame time. Values come from a background search and fill in as they
+ * arrive. Selecting a node makes its position available as a preview.
+ */
+class GameTreeView
+{
+private:
+    static constexpr uint32_t NoNode = UINT32_MAX;
+    static constexpr float RowHeight = 20.0f;
+    static constexpr float Indent = 14.0f;
+    static constexpr int AnalysisDepth = 8;
+    static constexpr uint64_t AnalysisNodes = 200000;
+
+    struct Node
+    {
+        uint32_t parent;
+        uint32_t firstChild; // Children are contiguous once generated
+        uint16_t depth;
+        uint8_t childCount;
+        uint8_t mover; // Player who made the move leading here
+        bool generated;
+        bool expanded;
+        bool terminal;
+        bool valued;
+        int32_t score; // From the first player's point of view
+        Move move;     // Move leading here; unused for the root
+    };
+
+    struct Job
+    {
+        uint64_t generation;
+        uint32_t node;
+        Position position;
+    };
+
+    struct Finished
+    {
+        uint64_t generation;
+        uint32_t node;
+        int32_t score;
+    };
+
+    sf::RenderWindow window;
+    sf::Text label;
+
+    Position root;
+    std::vector<Node> nodes;
+    std::vector<uint32_t> rows; // Visible nodes in display order
+    float scroll = 0.0f;
+    size_t selectedRow = 0;
+    bool previewing = false;
+    Position preview;
+    bool requestsDirty = true;
+
+    // Background analysis, shared with the worker under jobMutex
+    std::mutex jobMutex;
+    std::condition_variable jobReady;
+    std::deque<Job> jobs;
+    std::vector<Finished> finished;
+    uint64_t generation = 0;
+    bool quit = false;
+    std::atomic<bool> abandon{false};
+    std::thread worker;
+
+    static Node makeNode(uint32_t parent, uint16_t depth, int mover, const Move &move)
+    {
+        return {parent, NoNode, depth, 0, static_cast<uint8_t>(mover), false, false, false, false, 0, move};
+    }
+
+    static int32_t whiteScore(const Position &pos, int score)
+    {
+        return pos.getSideToMove() == 0 ? score : -score;
+    }
+
+    static int32_t terminalScore(const Position &pos)
+    {
+        const int winner = pos.winner();
+        if (winner < 0)
+            return 0;
+        return winner == 0 ? Search::MateScore : -Search::MateScore;
+    }
+
+    static std::string formatScore(const Node &node)
+    {
+        if (!node.valued)
+            return "...";
+        const int score = node.score;
+        const int plies = Search::MateScore - std::abs(score);
+        if (plies < 1000)
+        {
+            const std::string player = score > 0 ? "P1" : "P2";
+            return plies == 0 ? player + " won" : player + " wins in " + std::to_string(plies);
+        }
+        if (node.terminal)
+            return "stalled";
+        return (score > 0 ? "+" : "") + std::to_string(score);
+    }
+
+    // Replay the moves from the root; paths are short next to generating them
+    Position positionOf(uint32_t index) const
+    {
+        std::vector<uint32_t> path;
+        for (uint32_t current = index; current != 0; current = nodes[current].parent)
+            path.push_back(current);
+
+        Position pos = root;
+        for (auto it = path.rbegin(); it != path.rend(); ++it)
+            pos.makeMove(nodes[*it].move);
+        return pos;
+    }
+
+    void generateChildren(uint32_t index)
+    {
+        if (nodes[index].generated)
+            return;
+
+        Position pos = positionOf(index);
+        Move moves[Position::MaxMoves];
+        const int count = pos.isGameOver() ? 0 : pos.generateMoves(moves);
+
+        const uint32_t first = static_cast<uint32_t>(nodes.size());
+        const uint16_t depth = static_cast<uint16_t>(nodes[index].depth + 1);
+        for (int i = 0; i < count; ++i)
+        {
+            Node child = makeNode(index, depth, pos.getSideToMove(), moves[i]);
+            const Position::Undo undo = pos.makeMove(moves[i]);
+            if (pos.isGameOver())
+            {
+                child.terminal = true;
+                child.valued = true;
+                child.score = terminalScore(pos);
+            }
+            pos.unmakeMove(undo);
+            nodes.push_back(child);
+        }
+
+        Node &node = nodes[index];
+        node.generated = true;
+        node.firstChild = first;
+        node.childCount = static_cast<uint8_t>(count);
+    }
+
+    // Visible descendants of an expanded node, in display order
+    void collectVisible(uint32_t index, std::vector<uint32_t> &out) const
+    {
+        std::vector<uint32_t> stack;
+        const Node &start = nodes[index];
+        for (int i = start.childCount - 1; i >= 0; --i)
+            stack.push_back(start.firstChild + i);
+
+        while (!stack.empty())
+        {
+            const uint32_t current = stack.back();
+            stack.pop_back();
+            out.push_back(current);
+
+            const Node &node = nodes[current];
+            if (!node.expanded)
+                continue;
+            for (int i = node.childCount - 1; i >= 0; --i)
+                stack.push_back(node.firstChild + i);
+        }
+    }
+
+    void expand(size_t row)
+    {
+        const uint32_t index = rows[row];
+        if (nodes[index].expanded || nodes[index].terminal)
+            return;
+
+        generateChildren(index);
+        nodes[index].expanded = true;
+
+        std::vector<uint32_t> inserted;
+        collectVisible(index, inserted);
+        rows.insert(rows.begin() + row + 1, inserted.begin(), inserted.end());
+        if (selectedRow > row)
+            selectedRow += inserted.size();
+        requestsDirty = true;
+    }
+
+    // Children keep their own expanded state for when the node is reopened
+    void collapse(size_t row)
+    {
+        const uint32_t index = rows[row];
+        if (!nodes[index].expanded)
+            return;
+
+        nodes[index].expanded = false;
+        size_t end = row + 1;
+        while (end < rows.size() && nodes[rows[end]].depth > nodes[index].depth)
+            ++end;
+        rows.erase(rows.begin() + row + 1, rows.begin() + end);
+        if (selectedRow > row && selectedRow < end)
+            selectedRow = row;
+        else if (selectedRow >= end)
+            selectedRow -= end - row - 1;
+        requestsDirty = true;
+    }
+
+    float viewHeight() const
+    {
+        return static_cast<float>(window.getSize().y);
+    }
+
+    void clampScroll()
+    {
+        const float maxScroll = std::max(0.0f, rows.size() * RowHeight - viewHeight());
+        scroll = std::clamp(scroll, 0.0f, maxScroll);
+        requestsDirty = true;
+    }
+
+    void select(size_t row)
+    {
+        if (rows.empty())
+            return;
+        selectedRow = std::min(row, rows.size() - 1);
+
+        // Keep the selection on screen
+        const float top = selectedRow * RowHeight;
+        if (top < scroll)
+            scroll = top;
+        else if (top + RowHeight > scroll + viewHeight())
+            scroll = top + RowHeight - viewHeight();
+        clampScroll();
+
+        // The root is what the board already shows
+        previewing = rows[selectedRow] != 0;
+        if (previewing)
+            preview = positionOf(rows[selectedRow]);
+    }
+
+    void handleClick(const sf::Vector2i &point)
+    {
+        const size_t row = static_cast<size_t>((point.y + scroll) / RowHeight);
+        if (point.y < 0 || row >= rows.size())
+            return;
+
+        // Clicking the +/- box toggles, anywhere else on the row selects
+        const float boxLeft = 4.0f + nodes[rows[row]].depth * Indent;
+        if (point.x >= boxLeft && point.x < boxLeft + RowHeight)
+        {
+            if (nodes[rows[row]].expanded)
+                collapse(row);
+            else
+                expand(row);
+        }
+        select(row);
+    }
+
+    void handleKey(sf::Keyboard::Key key)
+    {
+        const size_t page = std::max<size_t>(1, static_cast<size_t>(viewHeight() / RowHeight) - 1);
+        switch (key)
+        {
+        case sf::Keyboard::Key::Up:
+            select(selectedRow > 0 ? selectedRow - 1 : 0);
+            break;
+        case sf::Keyboard::Key::Down:
+            select(selectedRow + 1);
+            break;
+        case sf::Keyboard::Key::PageUp:
+            select(selectedRow > page ? selectedRow - page : 0);
+            break;
+        case sf::Keyboard::Key::PageDown:
+            select(selectedRow + page);
+            break;
+        case sf::Keyboard::Key::Home:
+            select(0);
+            break;
+        case sf::Keyboard::Key::End:
+            select(rows.size() - 1);
+            break;
+        case sf::Keyboard::Key::Right:
+            expand(selectedRow);
+            break;
+        case sf::Keyboard::Key::Left:
+        {
+            // Collapse, or jump to the parent when already collapsed
+            const uint32_t index = rows[selectedRow];
+            if (nodes[index].expanded)
+            {
+                collapse(selectedRow);
+                break;
+            }
+            size_t row = selectedRow;
+            while (row > 0 && nodes[rows[row]].depth >= nodes[index].depth)
+                --row;
+            select(row);
+            break;
+        }
+        case sf::Keyboard::Key::Escape:
+            previewing = false;
+            break;
+        default:
+            break;
+        }
+    }
+
+    void handleEvents()
+    {
+        while (auto event = window.pollEvent())
+        {
+            if (event->is<sf::Event::Closed>())
+            {
+                window.close();
+                previewing = false;
+                return;
+            }
+            if (auto *resized = event->getIf<sf::Event::Resized>())
+            {
+                window.setView(sf::View(sf::FloatRect({0.0f, 0.0f}, sf::Vector2f(resized->size))));
+                clampScroll();
+            }
+            if (auto *wheel = event->getIf<sf::Event::MouseWheelScrolled>())
+            {
+                scroll -= wheel->delta * 3 * RowHeight;
+                clampScroll();
+            }
+            if (auto *mousePress = event->getIf<sf::Event::MouseButtonPressed>())
+            {
+                if (mousePress->button == sf::Mouse::Button::Left)
+                    handleClick(mousePress->position);
+            }
+            if (auto *keyPress = event->getIf<sf::Event::KeyPressed>())
+                handleKey(keyPress->code);
+        }
+    }
+
+    std::pair<size_t, size_t> visibleRange() const
+    {
+        const size_t first = static_cast<size_t>(scroll / RowHeight);
+        const size_t count = static_cast<size_t>(viewHeight() / RowHeight) + 2;
+        return {std::min(first, rows.size()), std::min(first + count, rows.size())};
+    }
+
+    // Queue the unvalued rows on screen, replacing whatever was queued before
+    void requestVisibleValues()
+    {
+        if (!requestsDirty)
+            return;
+        requestsDirty = false;
+
+        std::deque<Job> wanted;
+        const auto [first, last] = visibleRange();
+        for (size_t row = first; row < last; ++row)
+        {
+            if (!nodes[rows[row]].valued)
+                wanted.push_back({generation, rows[row], positionOf(rows[row])});
+        }
+
+        std::lock_guard<std::mutex> lock(jobMutex);
+        jobs = std::move(wanted);
+        jobReady.notify_one();
+    }
+
+    void collectFinished()
+    {
+        std::vector<Finished> results;
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            results.swap(finished);
+        }
+        for (const Finished &result : results)
+        {
+            if (result.generation != generation)
+                continue;
+            nodes[result.node].valued = true;
+            nodes[result.node].score = result.score;
+        }
+    }
+
+    void analyzeLoop()
+    {
+        Search search(16);
+        std::unique_lock<std::mutex> lock(jobMutex);
+        while (true)
+        {
+            jobReady.wait(lock, [&]
+                          { return quit || !jobs.empty(); });
+            if (quit)
+                return;
+
+            Job job = std::move(jobs.front());
+            jobs.pop_front();
+            abandon = false;
+            lock.unlock();
+
+            Search::Limits limits;
+            limits.depth = AnalysisDepth;
+            limits.nodes = AnalysisNodes;
+            limits.stop = &abandon;
+            const Search::Info info = search.run(job.position, limits);
+
+            lock.lock();
+            if (info.depth > 0 && job.generation == generation)
+                finished.push_back({job.generation, job.node, whiteScore(job.position, info.score)});
+        }
+    }
+
+    void drawRow(size_t row, float y)
+    {
+        const uint32_t index = rows[row];
+        const Node &node = nodes[index];
+        const float width = static_cast<float>(window.getSize().x);
+
+        if (row == selectedRow)
+        {
+            sf::RectangleShape highlight({width, RowHeight});
+            highlight.setPosition({0.0f, y});
+            highlight.setFillColor(sf::Color(60, 80, 120));
+            window.draw(highlight);
+        }
+
+        const float x = 4.0f + node.depth * Indent;
+        std::string text = node.terminal ? "  " : (node.expanded ? "- " : "+ ");
+        if (index == 0)
+        {
+            text += "Current position";
+        }
+        else
+        {
+            text += (node.mover == 0 ? "P1 " : "P2 ") + root.moveToString(node.move);
+        }
+        label.setString(text);
+        label.setPosition({x, y + 1.0f});
+        label.setFillColor(sf::Color::White);
+        window.draw(label);
+
+        label.setString(formatScore(node));
+        label.setPosition({std::max(x + 160.0f, width - 130.0f), y + 1.0f});
+        label.setFillColor(node.valued ? sf::Color(230, 230, 140) : sf::Color(140, 140, 140));
+        window.draw(label);
+    }
+
+    void render()
+    {
+        window.clear(sf::Color(30, 30, 30));
+
+        const auto [first, last] = visibleRange();
+        for (size_t row = first; row < last; ++row)
+            drawRow(row, row * RowHeight - scroll);
+
+        // Scrollbar thumb sized by the visible fraction
+        const float total = rows.size() * RowHeight;
+        if (total > viewHeight())
+        {
+            const float thumb = std::max(20.0f, viewHeight() * viewHeight() / total);
+            sf::RectangleShape bar({6.0f, thumb});
+            bar.setPosition({window.getSize().x - 8.0f, scroll / (total - viewHeight()) * (viewHeight() - thumb)});
+            bar.setFillColor(sf::Color(120, 120, 120));
+            window.draw(bar);
+        }
+
+        window.display();
+    }
+
+public:
+    GameTreeView(const sf::Font &font, const Position &start)
+        : label(font, "", 14), root(start), preview(start)
+    {
+        setRoot(start);
+        worker = std::thread(&GameTreeView::analyzeLoop, this);
+    }
+
+    ~GameTreeView()
+    {
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            quit = true;
+            abandon = true;
+        }
+        jobReady.notify_one();
+        worker.join();
+    }
+
+    GameTreeView(const GameTreeView &) = delete;
+    GameTreeView &operator=(const GameTreeView &) = delete;
+
+    void open()
+    {
+        if (window.isOpen())
+            return;
+        window.create(sf::VideoMode({420, 600}), "Game Tree");
+        window.setFramerateLimit(60);
+        requestsDirty = true;
+    }
+
+    bool isOpen() const { return window.isOpen(); }
+
+    // Start over from a new position, dropping all analysis in flight
+    void setRoot(const Position &start)
+    {
+        root = start;
+        nodes.assign(1, makeNode(NoNode, 0, 0, Move{0, 0, 0}));
+        if (root.isGameOver())
+        {
+            nodes[0].terminal = true;
+            nodes[0].valued = true;
+            nodes[0].score = terminalScore(root);
+        }
+        rows.assign(1, 0);
+        scroll = 0.0f;
+        selectedRow = 0;
+        previewing = false;
+        expand(0);
+
+        std::lock_guard<std::mutex> lock(jobMutex);
+        ++generation;
+        jobs.clear();
+        finished.clear();
+        abandon = true;
+    }
+
+    bool hasPreview() const { return previewing; }
+    const Position &getPreview() const { return preview; }
+    void clearPreview() { previewing = false; }
+
+    // Handle input, pick up finished analysis and redraw; call once per frame
+    void update()
+    {
+        if (!window.isOpen())
+            return;
+        handleEvents();
+        if (!window.isOpen())
+            return;
+        collectFinished();
+        requestVisibleValues();
+        render();
+    }
+};
+
+#endif // GAMETREEVIEW_H
@@ -0,0 +1,156 @@
+#ifndef LINESOCKET_H
+#define LINESOCKET_H
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+/**
+ * TCP connection carrying newline-terminated text messages (POSIX only).
+ *
+ * receive() appends whatever the socket has to an internal buffer and
+ * nextLine() pops complete lines from it, so the same object works for
+ * blocking readers and for poll() driven loops.
+ */
+class LineSocket
+{
+private:
+    int fd;
+    std::string buffer;
+
+public:
+    explicit LineSocket(int socketFd) : fd(socketFd)
+    {
+        const int noDelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    }
+
+    ~LineSocket()
+    {
+        if (fd >= 0)
+            close(fd);
+    }
+
+    LineSocket(const LineSocket &) = delete;
+    LineSocket &operator=(const LineSocket &) = delete;
+
+    static LineSocket connectTo(const std::string &host, uint16_t port)
+    {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo *addresses = nullptr;
+        if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0)
+            throw std::runtime_error("Cannot resolve " + host);
+
+        int socketFd = -1;
+        for (addrinfo *address = addresses; address; address = address->ai_next)
+        {
+            socketFd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+            if (socketFd < 0)
+                continue;
+            if (connect(socketFd, address->ai_addr, address->ai_addrlen) == 0)
+                break;
+            close(socketFd);
+            socketFd = -1;
+        }
+        freeaddrinfo(addresses);
+
+        if (socketFd < 0)
+            throw std::runtime_error("Cannot connect to " + host + ":" + std::to_string(port));
+        return LineSocket(socketFd);
+    }
+
+    // Listening socket on an IPv4 address, loopback unless told otherwise; returns the file descriptor
+    static int listenOn(uint16_t port, const std::string &address = "127.0.0.1", int backlog = 64)
+    {
+        sockaddr_in bound{};
+        bound.sin_family = AF_INET;
+        bound.sin_port = htons(port);
+        if (inet_pton(AF_INET, address.c_str(), &bound.sin_addr) != 1)
+            throw std::runtime_error("Not an IPv4 address: " + address);
+
+        const int socketFd = socket(AF_INET, SOCK_STREAM, 0);
+        if (socketFd < 0)
+            throw std::runtime_error("Cannot create socket");
+
+        const int reuse = 1;
+        setsockopt(socketFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        if (bind(socketFd, reinterpret_cast<sockaddr *>(&bound), sizeof(bound)) != 0 ||
+            listen(socketFd, backlog) != 0)
+        {
+            close(socketFd);
+            throw std::runtime_error("Cannot listen on " + address + ":" + std::to_string(port));
+        }
+        return socketFd;
+    }
+
+    LineSocket(LineSocket &&other) noexcept : fd(other.fd), buffer(std::move(other.buffer))
+    {
+        other.fd = -1;
+    }
+
+    int getFd() const { return fd; }
+
+    bool sendLine(const std::string &line)
+    {
+        const std::string message = line + "\n";
+        size_t sent = 0;
+        while (sent < message.size())
+        {
+            const ssize_t count = send(fd, message.data() + sent, message.size() - sent, MSG_NOSIGNAL);
+            if (count <= 0)
+                return false;
+            sent += static_cast<size_t>(count);
+        }
+        return true;
+    }
+
+    // Read once from the socket; false once the peer has gone away
+    bool receive()
+    {
+        char chunk[4096];
+        const ssize_t count = recv(fd, chunk, sizeof(chunk), 0);
+        if (count <= 0)
+            return false;
+        buffer.append(chunk, static_cast<size_t>(count));
+        return true;
+    }
+
+    bool nextLine(std::string &line)
+    {
+        const size_t end = buffer.find('\n');
+        if (end == std::string::npos)
+            return false;
+        line = buffer.substr(0, end);
+        buffer.erase(0, end + 1);
+        return true;
+    }
+
+    // Block until a complete line arrives; false if the peer disconnected
+    bool readLine(std::string &line)
+    {
+        while (!nextLine(line))
+        {
+            if (!receive())
+                return false;
+        }
+        return true;
+    }
+
+    bool isReadable(int timeoutMs) const
+    {
+        pollfd entry{fd, POLLIN, 0};
+        return poll(&entry, 1, timeoutMs) > 0;
+    }
+};
+
+#endif // LINESOCKET_H
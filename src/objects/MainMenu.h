@@ -4,9 +4,12 @@
 #include <SFML/Graphics.hpp>
 #include <SFML/Window.hpp>
 #include <SFML/System.hpp>
+#include <filesystem>
 #include <iostream>
 #include <string>
 #include <sstream>
+#include "AssetCache.h"
+#include "GameManager.h"
 
 class MainMenu
 {
@@ -20,12 +23,17 @@ private:
     };
 
     sf::RenderWindow window;
-    sf::Font font;
+    AssetCache assets; // Starts loading game assets while the menu is shown
+    const sf::Font &font;
 
     // Text objects initialized with font
     sf::Text title;
     sf::Text playButton;
+    sf::Text resumeButton;
+    sf::Text replayButton;
     sf::Text exitButton;
+    bool hasSavedGame = false;
+    bool hasRecord = false;
 
     InputField player1Field;
     InputField player2Field;
@@ -59,21 +67,13 @@ private:
         field.content.setPosition(sf::Vector2f(60, yPos + 5));
     }
 
-    sf::Font loadFont()
-    {
-        sf::Font localFont;
-        if (!localFont.openFromFile("arial.ttf"))
-        {
-            throw std::runtime_error("Failed to load font!");
-        }
-        return localFont;
-    }
-
 public:
     MainMenu() : window(sf::VideoMode({600, 600}), "Main Menu"),
-                 font(loadFont()),
+                 font(assets.getFont()),
                  title(font, "", 40),
                  playButton(font, "", 30),
+                 resumeButton(font, "", 30),
+                 replayButton(font, "", 30),
                  exitButton(font, "", 30),
                  player1Field{
                      sf::RectangleShape{},
@@ -97,8 +97,12 @@ public:
         createInputField(boardSizeField, 350, "Board Size:");
 
         // Buttons configuration
-        initializeText(playButton, "Start Game", 450);
-        initializeText(exitButton, "Exit", 520);
+        initializeText(playButton, "Start Game", 425);
+        initializeText(resumeButton, "Resume Game", 465);
+        initializeText(replayButton, "Replay Last Game", 505);
+        initializeText(exitButton, "Exit", 545);
+        hasSavedGame = std::filesystem::exists(GameManager::SavePath);
+        hasRecord = std::filesystem::exists(GameManager::RecordPath);
 
         // Input background
         inputBackground.setSize(sf::Vector2f(580, 300));
@@ -189,16 +193,62 @@ private:
                 const std::string player1Name = getPlayer1Name();
                 const std::string player2Name = getPlayer2Name();
 
-                GameManager gameManager(bSize, player1Name, player2Name);
+                assets.finalize();
+                GameManager gameManager(bSize, player1Name, player2Name, assets);
                 gameManager.run();
+                hasSavedGame = std::filesystem::exists(GameManager::SavePath);
+                hasRecord = std::filesystem::exists(GameManager::RecordPath);
             }
         }
+        else if (hasSavedGame && resumeButton.getGlobalBounds().contains(mousePos))
+        {
+            resumeGame();
+        }
+        else if (hasRecord && replayButton.getGlobalBounds().contains(mousePos))
+        {
+            replayGame();
+        }
         else if (exitButton.getGlobalBounds().contains(mousePos))
         {
             window.close();
         }
     }
 
+    void resumeGame()
+    {
+        try
+        {
+            const GameSnapshot snapshot = GameSnapshot::load(GameManager::SavePath);
+            const GameRecord history = GameManager::savedRecord(snapshot);
+            assets.finalize();
+            GameManager gameManager(snapshot, history, assets);
+            gameManager.run();
+        }
+        catch (const std::exception &ex)
+        {
+            std::cerr << "Failed to resume: " << ex.what() << std::endl;
+        }
+        hasSavedGame = std::filesystem::exists(GameManager::SavePath);
+        hasRecord = std::filesystem::exists(GameManager::RecordPath);
+    }
+
+    void replayGame()
+    {
+        try
+        {
+            const GameRecord record = GameRecord::load(GameManager::RecordPath);
+            assets.finalize();
+            GameManager gameManager(record, assets);
+            gameManager.run();
+        }
+        catch (const std::exception &ex)
+        {
+            std::cerr << "Failed to replay: " << ex.what() << std::endl;
+        }
+        hasSavedGame = std::filesystem::exists(GameManager::SavePath);
+        hasRecord = std::filesystem::exists(GameManager::RecordPath);
+    }
+
     void handleTextInput(const sf::Event::TextEntered &event)
     {
         auto processField = [&](InputField &field, bool numbersOnly = false)
@@ -293,6 +343,10 @@ private:
         // Draw buttons
         window.draw(title);
         window.draw(playButton);
+        if (hasSavedGame)
+            window.draw(resumeButton);
+        if (hasRecord)
+            window.draw(replayButton);
         window.draw(exitButton);
 
         window.display();
@@ -0,0 +1,170 @@
+#ifndef MEMORYBUDGET_H
+#define MEMORYBUDGET_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * One memory limit for a process, split between its subsystems.
+ *
+ * Every subsystem gets an Account holding a share of the limit. Tables
+ * and caches size themselves to what their account allows; structures
+ * that grow charge as they go and shrink, evict or refuse work when a
+ * charge does not fit. Counters are atomic so worker threads can charge
+ * their own accounts. A limit of 0 means unlimited; usage is still
+ * counted, so the stats are there either way.
+ */
+class MemoryBudget
+{
+public:
+    struct Usage
+    {
+        std::string name;
+        size_t used;
+        size_t peak;
+        size_t limit; // 0 if unlimited
+        uint64_t refused; // Charges that did not fit
+    };
+
+    class Account
+    {
+    private:
+        std::string name;
+        size_t limit;
+        std::atomic<size_t> used{0};
+        std::atomic<size_t> peak{0};
+        std::atomic<uint64_t> refused{0};
+
+        void raisePeak(size_t value)
+        {
+            size_t seen = peak.load(std::memory_order_relaxed);
+            while (value > seen && !peak.compare_exchange_weak(seen, value, std::memory_order_relaxed))
+            {
+            }
+        }
+
+    public:
+        Account(const std::string &accountName, size_t limitBytes) : name(accountName), limit(limitBytes) {}
+
+        // Charge bytes about to be allocated; false, and nothing charged, if they do not fit
+        bool tryCharge(size_t bytes)
+        {
+            size_t current = used.load(std::memory_order_relaxed);
+            do
+            {
+                if (limit != 0 && (bytes > limit || current > limit - bytes))
+                {
+                    refused.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+            } while (!used.compare_exchange_weak(current, current + bytes, std::memory_order_relaxed));
+            raisePeak(current + bytes);
+            return true;
+        }
+
+        // Charge bytes that are allocated regardless, e.g. a buffer that has already grown
+        void charge(size_t bytes)
+        {
+            raisePeak(used.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+        }
+
+        void release(size_t bytes)
+        {
+            used.fetch_sub(bytes, std::memory_order_relaxed);
+        }
+
+        // Bytes left before the limit; SIZE_MAX if unlimited
+        size_t available() const
+        {
+            if (limit == 0)
+                return SIZE_MAX;
+            const size_t current = used.load(std::memory_order_relaxed);
+            return current < limit ? limit - current : 0;
+        }
+
+        bool overLimit() const { return limit != 0 && used.load(std::memory_order_relaxed) > limit; }
+
+        const std::string &getName() const { return name; }
+        size_t getLimit() const { return limit; }
+        size_t getUsed() const { return used.load(std::memory_order_relaxed); }
+
+        Usage usage() const
+        {
+            return {name, used.load(std::memory_order_relaxed), peak.load(std::memory_order_relaxed), limit,
+                    refused.load(std::memory_order_relaxed)};
+        }
+    };
+
+private:
+    size_t limit;
+    double shared = 0; // Shares handed out so far
+    std::deque<Account> accounts; // Stable addresses
+
+public:
+    explicit MemoryBudget(size_t limitBytes) : limit(limitBytes) {}
+
+    MemoryBudget(const MemoryBudget &) = delete;
+    MemoryBudget &operator=(const MemoryBudget &) = delete;
+
+    /**
+     * Add a subsystem owning share (0 to 1) of the limit. Shares may not
+     * add up to more than 1. Set up every account before the subsystems
+     * start using them.
+     */
+    Account &add(const std::string &name, double share)
+    {
+        if (share <= 0 || shared + share > 1.0 + 1e-9)
+            throw std::runtime_error("Memory shares exceed the budget at " + name);
+        shared += share;
+        const size_t bytes = limit == 0 ? 0 : std::max<size_t>(static_cast<size_t>(limit * share), 1);
+        accounts.emplace_back(name, bytes);
+        return accounts.back();
+    }
+
+    size_t getLimit() const { return limit; }
+
+    size_t getUsed() const
+    {
+        size_t total = 0;
+        for (const Account &account : accounts)
+            total += account.getUsed();
+        return total;
+    }
+
+    std::vector<Usage> usage() const
+    {
+        std::vector<Usage> all;
+        for (const Account &account : accounts)
+            all.push_back(account.usage());
+        return all;
+    }
+
+    // "name used/limit MB" per account, e.g. for a stats line
+    static std::string describe(const std::vector<Usage> &all)
+    {
+        std::string text;
+        char part[128];
+        for (const Usage &usage : all)
+        {
+            const double used = usage.used / 1048576.0;
+            if (usage.limit)
+                std::snprintf(part, sizeof(part), "%s %.1f/%.1f MB", usage.name.c_str(), used, usage.limit / 1048576.0);
+            else
+                std::snprintf(part, sizeof(part), "%s %.1f MB", usage.name.c_str(), used);
+            if (!text.empty())
+                text += ", ";
+            text += part;
+            if (usage.refused)
+                text += " (" + std::to_string(usage.refused) + " refused)";
+        }
+        return text;
+    }
+};
+
+#endif // MEMORYBUDGET_H
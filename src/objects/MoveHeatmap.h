@@ -0,0 +1,261 @@
+#ifndef MOVEHEATMAP_H
+#define MOVEHEATMAP_H
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Position.h"
+#include "Search.h"
+
+/**
+ * Board overlay colouring every movable token of the side to move by the
+ * value of its move: green for wins, red for losses and a blend in between
+ * by evaluation margin.
+ *
+ * A worker thread deepens all root moves together, one depth at a time, so
+ * every token gets a rough value quickly and better ones as the turn goes
+ * on. Each token owns one quad of a single vertex array and only quads
+ * whose value changed are rewritten, so the overlay costs one draw call.
+ */
+class MoveHeatmap
+{
+public:
+    static constexpr int MaxDepth = 32;
+    static constexpr int MarginScale = 1000; // Evaluation at which the colour saturates
+
+private:
+    static constexpr int SolvedScore = Search::MateScore - 1000;
+
+    struct Finished
+    {
+        uint64_t generation;
+        uint8_t move;
+        int32_t score; // From the mover's point of view
+    };
+
+    float cellSize;
+    bool enabled = false;
+
+    // Render thread copy of the position being shown
+    Position root;
+    Move moves[Position::MaxMoves];
+    int moveCount = 0;
+    sf::VertexArray quads{sf::PrimitiveType::Triangles};
+
+    // Background analysis, shared with the worker under mutex
+    std::mutex mutex;
+    std::condition_variable jobReady;
+    bool pending = false;
+    Position job;
+    std::vector<Finished> finished;
+    uint64_t generation = 0;
+    bool quit = false;
+    std::atomic<bool> abandon{false};
+    std::thread worker;
+
+    static sf::Color colorFor(int32_t score)
+    {
+        if (score >= SolvedScore)
+            return {0, 200, 0, 150};
+        if (score <= -SolvedScore)
+            return {220, 0, 0, 150};
+
+        // Red through yellow to green
+        const float t = std::clamp(static_cast<float>(score) / MarginScale, -1.0f, 1.0f);
+        const auto red = static_cast<std::uint8_t>(t < 0 ? 230 : 230 * (1 - t));
+        const auto green = static_cast<std::uint8_t>(t > 0 ? 200 : 200 * (1 + t));
+        return {red, green, 0, 110};
+    }
+
+    void setQuadColor(int move, sf::Color color)
+    {
+        for (size_t v = 0; v < 6; ++v)
+            quads[move * 6 + v].color = color;
+    }
+
+    // One transparent quad per root move, over the token that makes it
+    void layoutQuads()
+    {
+        const BoardGrid &grid = root.getGrid();
+        quads.resize(moveCount * 6);
+        for (int i = 0; i < moveCount; ++i)
+        {
+            const sf::Vector2f topLeft(grid.column(moves[i].from) * cellSize, grid.row(moves[i].from) * cellSize);
+            const sf::Vector2f corners[4] = {topLeft, {topLeft.x + cellSize, topLeft.y},
+                                             {topLeft.x, topLeft.y + cellSize}, {topLeft.x + cellSize, topLeft.y + cellSize}};
+            static constexpr int order[6] = {0, 1, 2, 2, 1, 3};
+            for (size_t v = 0; v < 6; ++v)
+                quads[i * 6 + v].position = corners[order[v]];
+            setQuadColor(i, sf::Color::Transparent);
+        }
+    }
+
+    void startAnalysis()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++generation;
+        finished.clear();
+        abandon = true;
+        if (enabled && moveCount > 0)
+        {
+            job = root;
+            pending = true;
+            jobReady.notify_one();
+        }
+    }
+
+    void publish(uint64_t jobGeneration, int move, int32_t score)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (jobGeneration == generation)
+            finished.push_back({jobGeneration, static_cast<uint8_t>(move), score});
+    }
+
+    // Deepen every root move one ply at a time until all are solved or the job is dropped
+    void analyze(Search &search, const Position &pos, uint64_t jobGeneration)
+    {
+        Move rootMoves[Position::MaxMoves];
+        const int count = pos.generateMoves(rootMoves);
+        const int mover = pos.getSideToMove();
+        std::vector<bool> solved(count, false);
+
+        for (int depth = 1; depth <= MaxDepth; ++depth)
+        {
+            bool allSolved = true;
+            for (int i = 0; i < count; ++i)
+            {
+                if (solved[i])
+                    continue;
+                if (abandon)
+                    return;
+
+                Position child = pos;
+                child.makeMove(rootMoves[i]);
+                int32_t score;
+                if (child.isGameOver())
+                {
+                    const int winner = child.winner();
+                    score = winner < 0 ? 0 : (winner == mover ? Search::MateScore : -Search::MateScore);
+                    solved[i] = true;
+                }
+                else
+                {
+                    Search::Limits limits;
+                    limits.depth = depth;
+                    limits.stop = &abandon;
+                    const Search::Info info = search.run(child, limits);
+                    if (abandon)
+                        return;
+                    score = child.getSideToMove() == mover ? info.score : -info.score;
+                    solved[i] = std::abs(score) >= SolvedScore;
+                }
+                publish(jobGeneration, i, score);
+                allSolved = allSolved && solved[i];
+            }
+            if (allSolved)
+                return;
+        }
+    }
+
+    void analyzeLoop()
+    {
+        Search search(16);
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            jobReady.wait(lock, [&]
+                          { return quit || pending; });
+            if (quit)
+                return;
+
+            pending = false;
+            abandon = false;
+            const Position pos = job;
+            const uint64_t jobGeneration = generation;
+            lock.unlock();
+            analyze(search, pos, jobGeneration);
+            lock.lock();
+        }
+    }
+
+public:
+    MoveHeatmap(float cell, const Position &start)
+        : cellSize(cell), root(start), job(start)
+    {
+        worker = std::thread(&MoveHeatmap::analyzeLoop, this);
+        setPosition(start);
+    }
+
+    ~MoveHeatmap()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+            abandon = true;
+        }
+        jobReady.notify_one();
+        worker.join();
+    }
+
+    MoveHeatmap(const MoveHeatmap &) = delete;
+    MoveHeatmap &operator=(const MoveHeatmap &) = delete;
+
+    bool isEnabled() const { return enabled; }
+
+    // Showing the overlay (re)starts analysis of the current position; hiding it stops the worker
+    void toggle()
+    {
+        enabled = !enabled;
+        layoutQuads();
+        startAnalysis();
+    }
+
+    // A new turn: start valuing its moves right away
+    void setPosition(const Position &pos)
+    {
+        root = pos;
+        moveCount = root.isGameOver() ? 0 : root.generateMoves(moves);
+        layoutQuads();
+        startAnalysis();
+    }
+
+    // Show nothing and stop analysing, e.g. while the computer is thinking
+    void clear()
+    {
+        moveCount = 0;
+        quads.clear();
+        startAnalysis();
+    }
+
+    // Recolour the tokens whose value changed; call once per frame
+    void update()
+    {
+        std::vector<Finished> results;
+        uint64_t current;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (finished.empty())
+                return;
+            results.swap(finished);
+            current = generation;
+        }
+        for (const Finished &result : results)
+        {
+            if (result.generation == current && result.move < moveCount)
+                setQuadColor(result.move, colorFor(result.score));
+        }
+    }
+
+    void draw(sf::RenderTarget &target) const
+    {
+        if (enabled && moveCount > 0)
+            target.draw(quads);
+    }
+};
+
+#endif // MOVEHEATMAP_H
@@ -1,6 +1,7 @@
 #ifndef PLAYER_H
 #define PLAYER_H
 
+#include <algorithm>
 #include <vector>
 #include <iostream>
 #include <stdexcept>
@@ -11,7 +12,8 @@ class Player
 private:
     size_t MaxTokens;
     int playerNumber;
-    std::vector<Token *> tokens;
+    std::vector<Token *> tokens;       // Every token, owned by the player
+    std::vector<Token *> activeTokens; // Tokens still in play; retired ones are swap-removed
     int score;
     int movableTokens;
 
@@ -43,6 +45,28 @@ public:
             throw std::runtime_error("Cannot add more tokens: Maximum token limit reached.");
         }
         tokens.push_back(token);
+        if (!token->hasReachedEnd())
+        {
+            activeTokens.push_back(token);
+        }
+    }
+
+    // Take a token that reached the end out of play; it keeps its place in getTokens()
+    void retireToken(Token *token)
+    {
+        auto it = std::find(activeTokens.begin(), activeTokens.end(), token);
+        if (it == activeTokens.end())
+        {
+            return;
+        }
+        *it = activeTokens.back();
+        activeTokens.pop_back();
+    }
+
+    // Tokens that have not reached the end, in no particular order
+    const std::vector<Token *> &getActiveTokens() const
+    {
+        return activeTokens;
     }
 
     // Get the player's tokens (const version)
@@ -81,17 +105,10 @@ public:
         movableTokens = count;
     }
 
-    // Check if the player has any movable tokens
+    // Check if the player has any movable tokens, as of the last updateMovableTokens()
     bool hasMovableTokens() const
     {
-        for (const auto &token : tokens)
-        {
-            if (token->isMovable())
-            {
-                return true;
-            }
-        }
-        return false;
+        return movableTokens > 0;
     }
 
     // Non-const version of getTokens for modification
@@ -100,11 +117,11 @@ public:
         return tokens;
     }
 
-    // Update the movable tokens based on the game board
+    // Update the movable tokens based on the game board; retired tokens never move
     void updateMovableTokens()
     {
         movableTokens = 0;
-        for (auto &token : tokens)
+        for (auto &token : activeTokens)
         {
             if (token->isMovable())
             {
@@ -0,0 +1,278 @@
+#ifndef POSITION_H
+#define POSITION_H
+
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "BoardGrid.h"
+
+// A move between two BoardGrid indices; slot is the token's index in its
+// player's token list
+struct Move
+{
+    uint16_t from;
+    uint16_t to;
+    uint8_t slot;
+};
+
+// splitmix64 finalizer, used to derive Zobrist keys without tables
+inline uint64_t mixHash(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// FNV-1a over a byte range; pass the previous result to continue a running checksum
+inline uint64_t fnv1a(const uint8_t *data, size_t length, uint64_t hash = 0xcbf29ce484222325ULL)
+{
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/**
+ * Lightweight game position for analysis.
+ *
+ * Holds only occupancy, scores and the side to move; no tokens, textures
+ * or windows. Moves follow GameState: the mover scores when a token lands
+ * on the board edge, play passes to the opponent only if they have a
+ * movable token, and the game ends when a player has brought every token
+ * home or nobody can move.
+ */
+class Position
+{
+public:
+    static constexpr int MaxMoves = 49; // Tokens per player on a 51x51 board
+
+    struct Undo
+    {
+        Move move;
+        int8_t side;
+        bool scored;
+    };
+
+private:
+    BoardGrid grid;
+    int tokensPerPlayer;
+    int sideToMove;
+    int scores[2];
+    std::vector<uint16_t> tokens[2]; // Grid index of each token, by player
+    uint64_t hash;
+
+    uint64_t cellKey(size_t idx, int player) const
+    {
+        return mixHash((static_cast<uint64_t>(grid.getWidth()) << 32) ^ (idx << 1) ^ player);
+    }
+
+    static constexpr uint64_t SideKey = 0x5bd1e9955bd1e995ULL;
+
+    void setup(int side)
+    {
+        sideToMove = side;
+        scores[0] = scores[1] = 0;
+        hash = side == 1 ? SideKey : 0;
+        for (size_t idx = grid.firstIndex(); idx < grid.endIndex(); ++idx)
+        {
+            if (!grid.isOccupied(idx))
+                continue;
+
+            const int player = BoardGrid::cellPlayer(grid.at(idx));
+            tokens[player].push_back(static_cast<uint16_t>(idx));
+            hash ^= cellKey(idx, player);
+
+            // Tokens on the far side have scored
+            const size_t last = grid.getWidth() - 1;
+            if (player == 0 ? static_cast<size_t>(grid.column(idx)) == last
+                            : static_cast<size_t>(grid.row(idx)) == last)
+            {
+                ++scores[player];
+            }
+        }
+    }
+
+public:
+    // Start position of a size x size game, as set up by GameState
+    explicit Position(size_t size)
+        : grid(size, size), tokensPerPlayer(static_cast<int>(size - 2))
+    {
+        for (size_t i = 0; i < size - 2; ++i)
+        {
+            grid.set(grid.index(0, i + 1), BoardGrid::Player0);
+            grid.set(grid.index(i + 1, 0), BoardGrid::Player1);
+        }
+        setup(0);
+    }
+
+    // Position from an existing square grid
+    Position(const BoardGrid &board, int side)
+        : grid(board), tokensPerPlayer(static_cast<int>(board.getWidth() - 2))
+    {
+        setup(side);
+    }
+
+    size_t getSize() const { return grid.getWidth(); }
+    const BoardGrid &getGrid() const { return grid; }
+    int getSideToMove() const { return sideToMove; }
+    int getScore(int player) const { return scores[player]; }
+    int getTokensPerPlayer() const { return tokensPerPlayer; }
+    const std::vector<uint16_t> &getTokens(int player) const { return tokens[player]; }
+    uint64_t getHash() const { return hash; }
+
+    // Heap memory held beyond sizeof(Position), for memory accounting
+    size_t getHeapBytes() const
+    {
+        return grid.size() + (tokens[0].capacity() + tokens[1].capacity()) * sizeof(uint16_t);
+    }
+
+    // Fill moves (capacity MaxMoves) for the side to move; returns the count
+    int generateMoves(Move *moves) const
+    {
+        int count = 0;
+        const std::vector<uint16_t> &own = tokens[sideToMove];
+        for (size_t slot = 0; slot < own.size(); ++slot)
+        {
+            const size_t landing = grid.landingIndex(own[slot]);
+            if (landing != BoardGrid::NoMove)
+            {
+                moves[count++] = {own[slot], static_cast<uint16_t>(landing),
+                                  static_cast<uint8_t>(slot)};
+            }
+        }
+        return count;
+    }
+
+    bool hasMoves(int player) const
+    {
+        for (uint16_t idx : tokens[player])
+        {
+            if (grid.canMove(idx))
+                return true;
+        }
+        return false;
+    }
+
+    // Winning player, or -1 while nobody has brought every token home
+    int winner() const
+    {
+        if (scores[0] >= tokensPerPlayer)
+            return 0;
+        if (scores[1] >= tokensPerPlayer)
+            return 1;
+        return -1;
+    }
+
+    bool isGameOver() const
+    {
+        return winner() >= 0 || !hasMoves(sideToMove);
+    }
+
+    Undo makeMove(const Move &move)
+    {
+        const int player = sideToMove;
+        Undo undo{move, static_cast<int8_t>(player), false};
+
+        grid.set(move.from, BoardGrid::Empty);
+        grid.set(move.to, BoardGrid::playerCell(player));
+        tokens[player][move.slot] = move.to;
+        hash ^= cellKey(move.from, player) ^ cellKey(move.to, player);
+
+        if (grid.isEdge(move.to))
+        {
+            ++scores[player];
+            undo.scored = true;
+        }
+
+        if (scores[player] < tokensPerPlayer && hasMoves(1 - player))
+        {
+            sideToMove = 1 - player;
+            hash ^= SideKey;
+        }
+        return undo;
+    }
+
+    void unmakeMove(const Undo &undo)
+    {
+        const int player = undo.side;
+        const Move &move = undo.move;
+
+        if (sideToMove != player)
+        {
+            sideToMove = player;
+            hash ^= SideKey;
+        }
+        if (undo.scored)
+        {
+            --scores[player];
+        }
+
+        grid.set(move.to, BoardGrid::Empty);
+        grid.set(move.from, BoardGrid::playerCell(player));
+        tokens[player][move.slot] = move.from;
+        hash ^= cellKey(move.from, player) ^ cellKey(move.to, player);
+    }
+
+    // Moves are written "fromX,fromY-toX,toY" in board coordinates
+    std::string moveToString(const Move &move) const
+    {
+        return std::to_string(grid.column(move.from)) + "," + std::to_string(grid.row(move.from)) + "-" +
+               std::to_string(grid.column(move.to)) + "," + std::to_string(grid.row(move.to));
+    }
+
+    /**
+     * Find the legal move of the side to move from (fromX, fromY) to
+     * (toX, toY). As with GameBoard::checkMove, the target may be the
+     * landing square or the square in front of the token.
+     */
+    bool findMove(int fromX, int fromY, int toX, int toY, Move &move) const
+    {
+        if (!grid.isValidPosition(fromX, fromY) || !grid.isValidPosition(toX, toY))
+            return false;
+
+        const size_t from = grid.index(fromX, fromY);
+        const size_t to = grid.index(toX, toY);
+        Move moves[MaxMoves];
+        const int count = isGameOver() ? 0 : generateMoves(moves);
+        for (int i = 0; i < count; ++i)
+        {
+            if (moves[i].from == from &&
+                (moves[i].to == to || from + grid.forwardOffset(sideToMove) == to))
+            {
+                move = moves[i];
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // findMove() for text written "fromX,fromY-toX,toY"
+    bool parseMove(const std::string &text, Move &move) const
+    {
+        int fromX, fromY, toX, toY;
+        char tail;
+        if (std::sscanf(text.c_str(), "%d,%d-%d,%d%c", &fromX, &fromY, &toX, &toY, &tail) != 4)
+            return false;
+        return findMove(fromX, fromY, toX, toY, move);
+    }
+
+    void print(std::ostream &out) const
+    {
+        for (size_t row = 0; row < grid.getHeight(); ++row)
+        {
+            for (size_t col = 0; col < grid.getWidth(); ++col)
+            {
+                const uint8_t cell = grid.at(col, row);
+                out << (cell != BoardGrid::Empty ? std::to_string(BoardGrid::cellPlayer(cell)) : ".") << " ";
+            }
+            out << "\n";
+        }
+    }
+};
+
+#endif // POSITION_H
@@ -0,0 +1,356 @@
+#ifndef PROOFSOLVER_H
+#define PROOFSOLVER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+#include "AnalysisCache.h"
+#include "Position.h"
+
+/**
+ * Depth-first proof-number (df-pn) solver.
+ *
+ * Proves or disproves that the side to move in a Position can force a
+ * win. Proof and disproof numbers are kept in a fixed-size table of
+ * two-entry buckets, so memory stays bounded no matter how large the
+ * search grows; entries that took the least work to compute are replaced
+ * first. The game only ever moves tokens forward, so positions never
+ * repeat and there is no graph-history problem to handle.
+ */
+class ProofSolver
+{
+public:
+    enum class Result
+    {
+        Win,    // The player being solved for forces a win
+        NoWin,  // Opponent wins or the game stalls
+        Unknown // Stopped before the root was resolved
+    };
+
+    struct Progress
+    {
+        uint64_t nodes;
+        uint32_t rootPn;
+        uint32_t rootDn;
+        size_t entriesUsed;
+        size_t entriesTotal;
+        double seconds;
+    };
+
+    using ProgressCallback = std::function<void(const Progress &)>;
+
+    static constexpr uint32_t Infinity = 0x3fffffff;
+
+private:
+    struct Entry
+    {
+        uint64_t hash;
+        uint32_t pn;
+        uint32_t dn;
+        uint32_t work;    // Nodes spent on this entry, used for replacement
+        uint8_t attacker; // Player the numbers are proving a win for
+        uint8_t used;
+    };
+
+    std::vector<Entry> table;
+    size_t bucketMask;
+    size_t entriesUsed = 0;
+    AnalysisCache *persistent = nullptr;
+
+    int attacker = 0;
+    uint64_t rootHash = 0;
+    uint64_t nodes = 0;
+    uint64_t nodeLimit = 0;
+    std::atomic<bool> stopRequested{false};
+
+    ProgressCallback progressCallback;
+    uint64_t progressInterval = 1 << 20;
+    std::chrono::steady_clock::time_point startTime;
+
+    static uint32_t addSaturated(uint32_t a, uint32_t b)
+    {
+        return std::min<uint32_t>(a + b, Infinity);
+    }
+
+    Entry *probe(uint64_t hash)
+    {
+        Entry *bucket = &table[(hash & bucketMask) * 2];
+        for (int i = 0; i < 2; ++i)
+        {
+            if (bucket[i].used && bucket[i].hash == hash && bucket[i].attacker == attacker)
+                return &bucket[i];
+        }
+        return nullptr;
+    }
+
+    void store(uint64_t hash, uint32_t pn, uint32_t dn, uint64_t work)
+    {
+        const uint32_t clampedWork = static_cast<uint32_t>(std::min<uint64_t>(work, UINT32_MAX));
+        Entry *target = probe(hash);
+        if (!target)
+        {
+            // Keep solved entries and whichever one represents more work
+            Entry *bucket = &table[(hash & bucketMask) * 2];
+            target = &bucket[0];
+            for (int i = 0; i < 2; ++i)
+            {
+                if (!bucket[i].used)
+                {
+                    target = &bucket[i];
+                    ++entriesUsed;
+                    break;
+                }
+                const bool solved = bucket[i].pn == 0 || bucket[i].dn == 0;
+                const bool targetSolved = target->pn == 0 || target->dn == 0;
+                if ((targetSolved && !solved) ||
+                    (targetSolved == solved && bucket[i].work < target->work))
+                {
+                    target = &bucket[i];
+                }
+            }
+        }
+        *target = {hash, pn, dn, clampedWork, static_cast<uint8_t>(attacker), 1};
+
+        if (persistent && (pn == 0 || dn == 0))
+        {
+            persistent->store(AnalysisCache::proofKey(hash, attacker),
+                              {pn == 0 ? 1 : 0, UINT16_MAX, 0, AnalysisCache::Proof});
+        }
+    }
+
+    // Proof and disproof numbers of a position, from the table or terminal state
+    void evaluate(const Position &pos, uint32_t &pn, uint32_t &dn)
+    {
+        if (pos.isGameOver())
+        {
+            const bool won = pos.winner() == attacker;
+            pn = won ? 0 : Infinity;
+            dn = won ? Infinity : 0;
+            return;
+        }
+        if (const Entry *entry = probe(pos.getHash()))
+        {
+            pn = entry->pn;
+            dn = entry->dn;
+            return;
+        }
+        AnalysisCache::Value cached;
+        if (persistent && persistent->probe(AnalysisCache::proofKey(pos.getHash(), attacker), cached) &&
+            cached.kind == AnalysisCache::Proof)
+        {
+            pn = cached.score ? 0 : Infinity;
+            dn = cached.score ? Infinity : 0;
+            return;
+        }
+        pn = 1;
+        dn = 1;
+    }
+
+    void reportProgress()
+    {
+        if (!progressCallback)
+            return;
+
+        Progress progress{nodes, 1, 1, entriesUsed, table.size(),
+                          std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count()};
+        if (const Entry *root = probe(rootHash))
+        {
+            progress.rootPn = root->pn;
+            progress.rootDn = root->dn;
+        }
+        progressCallback(progress);
+    }
+
+    bool shouldStop() const
+    {
+        return stopRequested.load(std::memory_order_relaxed) ||
+               (nodeLimit != 0 && nodes >= nodeLimit);
+    }
+
+    void mid(Position &pos, uint32_t thresholdPn, uint32_t thresholdDn)
+    {
+        if (++nodes % progressInterval == 0)
+            reportProgress();
+
+        const uint64_t startNodes = nodes;
+        const bool orNode = pos.getSideToMove() == attacker;
+
+        Move moves[Position::MaxMoves];
+        const int count = pos.generateMoves(moves);
+        uint32_t childPn[Position::MaxMoves];
+        uint32_t childDn[Position::MaxMoves];
+
+        uint32_t pn = 0;
+        uint32_t dn = 0;
+        while (true)
+        {
+            // Collect child numbers, tracking the best and second best child
+            int best = 0;
+            uint32_t secondBest = Infinity;
+            pn = orNode ? Infinity : 0;
+            dn = orNode ? 0 : Infinity;
+            for (int i = 0; i < count; ++i)
+            {
+                const Position::Undo undo = pos.makeMove(moves[i]);
+                evaluate(pos, childPn[i], childDn[i]);
+                pos.unmakeMove(undo);
+
+                // At an OR node we minimise pn, at an AND node we minimise dn
+                const uint32_t key = orNode ? childPn[i] : childDn[i];
+                const uint32_t bestKey = orNode ? childPn[best] : childDn[best];
+                if (i == 0 || key < bestKey)
+                {
+                    if (i != 0)
+                        secondBest = bestKey;
+                    best = i;
+                }
+                else if (key < secondBest)
+                {
+                    secondBest = key;
+                }
+
+                if (orNode)
+                {
+                    pn = std::min(pn, childPn[i]);
+                    dn = addSaturated(dn, childDn[i]);
+                }
+                else
+                {
+                    pn = addSaturated(pn, childPn[i]);
+                    dn = std::min(dn, childDn[i]);
+                }
+            }
+
+            if (pn >= thresholdPn || dn >= thresholdDn || shouldStop())
+                break;
+
+            store(pos.getHash(), pn, dn, nodes - startNodes);
+
+            uint32_t childThresholdPn;
+            uint32_t childThresholdDn;
+            if (orNode)
+            {
+                childThresholdPn = std::min(thresholdPn, addSaturated(secondBest, 1));
+                childThresholdDn = thresholdDn - dn + childDn[best];
+            }
+            else
+            {
+                childThresholdPn = thresholdPn - pn + childPn[best];
+                childThresholdDn = std::min(thresholdDn, addSaturated(secondBest, 1));
+            }
+
+            const Position::Undo undo = pos.makeMove(moves[best]);
+            mid(pos, childThresholdPn, childThresholdDn);
+            pos.unmakeMove(undo);
+        }
+
+        store(pos.getHash(), pn, dn, nodes - startNodes);
+    }
+
+public:
+    explicit ProofSolver(size_t tableMegabytes)
+    {
+        // Round the bucket count down to a power of two
+        size_t buckets = 1;
+        const size_t wanted = std::max<size_t>(tableMegabytes * 1024 * 1024 / (2 * sizeof(Entry)), 1);
+        while (buckets * 2 <= wanted)
+            buckets *= 2;
+
+        table.assign(buckets * 2, Entry{});
+        bucketMask = buckets - 1;
+    }
+
+    ProofSolver(const ProofSolver &) = delete;
+    ProofSolver &operator=(const ProofSolver &) = delete;
+
+    void setProgressCallback(ProgressCallback callback, uint64_t intervalNodes)
+    {
+        progressCallback = std::move(callback);
+        progressInterval = std::max<uint64_t>(intervalNodes, 1);
+    }
+
+    // Reuse and record solved positions in a persistent cache
+    void setPersistentCache(AnalysisCache *cache) { persistent = cache; }
+
+    // Give up after this many nodes; 0 means no limit
+    void setNodeLimit(uint64_t limit) { nodeLimit = limit; }
+
+    // May be called from another thread to abandon the current solve
+    void stop() { stopRequested = true; }
+
+    uint64_t getNodes() const { return nodes; }
+
+    /**
+     * Prove or disprove a forced win for forPlayer, which defaults to the
+     * side to move.
+     */
+    Result solve(const Position &start, int forPlayer = -1)
+    {
+        Position pos = start;
+        attacker = forPlayer >= 0 ? forPlayer : pos.getSideToMove();
+        rootHash = pos.getHash();
+        nodes = 0;
+        stopRequested = false;
+        startTime = std::chrono::steady_clock::now();
+
+        uint32_t pn;
+        uint32_t dn;
+        evaluate(pos, pn, dn);
+        while (pn != 0 && dn != 0 && !shouldStop())
+        {
+            mid(pos, Infinity, Infinity);
+            evaluate(pos, pn, dn);
+        }
+        reportProgress();
+
+        if (pn == 0)
+            return Result::Win;
+        if (dn == 0)
+            return Result::NoWin;
+        return Result::Unknown;
+    }
+
+    /**
+     * Write every solved table entry to a binary file: a "GTPN" header with
+     * version, board size and record count, then one record per position
+     * of hash, attacker and whether the attacker wins.
+     */
+    bool exportResults(const std::string &path, uint32_t boardSize) const
+    {
+        std::ofstream out(path, std::ios::binary);
+        if (!out)
+            return false;
+
+        uint64_t count = 0;
+        for (const Entry &entry : table)
+        {
+            if (entry.used && (entry.pn == 0 || entry.dn == 0))
+                ++count;
+        }
+
+        const uint32_t version = 1;
+        out.write("GTPN", 4);
+        out.write(reinterpret_cast<const char *>(&version), sizeof(version));
+        out.write(reinterpret_cast<const char *>(&boardSize), sizeof(boardSize));
+        out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+
+        for (const Entry &entry : table)
+        {
+            if (!entry.used || (entry.pn != 0 && entry.dn != 0))
+                continue;
+
+            const uint8_t won = entry.pn == 0 ? 1 : 0;
+            out.write(reinterpret_cast<const char *>(&entry.hash), sizeof(entry.hash));
+            out.write(reinterpret_cast<const char *>(&entry.attacker), 1);
+            out.write(reinterpret_cast<const char *>(&won), 1);
+        }
+        return static_cast<bool>(out);
+    }
+};
+
+#endif // PROOFSOLVER_H
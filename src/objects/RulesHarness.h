@@ -0,0 +1,599 @@
+#ifndef RULESHARNESS_H
+#define RULESHARNESS_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BoardGrid.h"
+#include "Position.h"
+
+/**
+ * Randomized differential test of a rules kernel against a reference.
+ *
+ * Games are played on every core with the same actions sent to both
+ * kernels: moves of the player to move (aimed at the square in front of a
+ * token, or at its landing square, as the UI does) and probes of
+ * checkMove() with arbitrary coordinates, which cover the error statuses.
+ * After every action the results must agree, and so must every cell a
+ * move can change: its own squares and the tokens up to two squares
+ * behind them, whose movable flags depend on those squares. The full
+ * board, with each token's movable and reached-end flags, is compared
+ * every FullCheckInterval moves and when a game ends, so the work per
+ * move does not grow with the board. A mismatch is shrunk by delta
+ * debugging to a short action sequence that still fails.
+ *
+ * A kernel is any default-constructible class with
+ *   void reset(size_t size);                                   start position
+ *   MoveResult checkMove(int fromX, int fromY, int toX, int toY) const;
+ *   MoveStatus move(int fromX, int fromY, int toX, int toY);   apply if legal
+ *   uint8_t observeCell(int x, int y) const;                   CellBits of one cell
+ *   void observe(std::vector<uint8_t> &cells) const;           CellBits, row-major
+ *
+ * Recorded games are finally replayed on each kernel alone to compare speed.
+ */
+template <class Reference, class Candidate>
+class DifferentialHarness
+{
+public:
+    static constexpr uint64_t FullCheckInterval = 64; // Moves between whole-board comparisons
+
+    enum CellBits : uint8_t
+    {
+        Player0 = 1,
+        Player1 = 2,
+        Movable = 4,
+        ReachedEnd = 8
+    };
+
+    struct Action
+    {
+        enum Kind : uint8_t
+        {
+            Probe,
+            Move
+        };
+        Kind kind;
+        int8_t fromX, fromY, toX, toY;
+    };
+
+    struct Options
+    {
+        uint64_t moves = 100000000;
+        unsigned threads = 1;
+        size_t minSize = 3;
+        size_t maxSize = 51;
+        uint64_t seed = 1;
+        size_t benchmarkGames = 2000; // Games kept for the speed comparison
+    };
+
+    struct Mismatch
+    {
+        uint64_t game;
+        size_t boardSize;
+        std::vector<Action> actions; // Shrunk; the last one exposes the difference
+        std::string description;
+    };
+
+    struct Progress
+    {
+        uint64_t games;
+        uint64_t moves;
+        uint64_t probes;
+        double seconds;
+    };
+
+    struct Report
+    {
+        uint64_t games = 0;
+        uint64_t moves = 0;
+        uint64_t probes = 0;
+        double seconds = 0;
+        bool passed = true;
+        Mismatch mismatch; // First mismatch found, when !passed
+        double referenceActionsPerSecond = 0;
+        double candidateActionsPerSecond = 0;
+    };
+
+    using ProgressCallback = std::function<void(const Progress &)>;
+
+private:
+    struct Recorded
+    {
+        size_t boardSize;
+        std::vector<Action> actions;
+    };
+
+    // State the driver keeps while feeding actions to both kernels
+    struct Replay
+    {
+        Reference reference;
+        Candidate candidate;
+        std::vector<uint8_t> referenceCells; // Kept current cell by cell between full checks
+        std::vector<uint8_t> candidateCells;
+        size_t size = 0;
+        int current = 0;
+        uint64_t moves = 0;
+
+        // Summary of the reference board, kept with referenceCells
+        int movable[2] = {0, 0};
+        int scored[2] = {0, 0};
+        std::vector<int> tokenCells[2]; // Row-major cell of every token, by player, in no order
+        std::vector<int> tokenSlot;     // Position in tokenCells of the token on each cell
+
+        void reset(size_t boardSize)
+        {
+            size = boardSize;
+            current = 0;
+            moves = 0;
+            reference.reset(size);
+            candidate.reset(size);
+        }
+
+        uint8_t cell(int x, int y) const { return referenceCells[y * size + x]; }
+
+        static int owner(uint8_t cell) { return (cell & Player0) ? 0 : ((cell & Player1) ? 1 : -1); }
+
+        bool isOver() const
+        {
+            const int goal = static_cast<int>(size) - 2;
+            return scored[0] >= goal || scored[1] >= goal || (movable[0] == 0 && movable[1] == 0);
+        }
+
+        // Where a forward move of the token at (x, y) really lands, resolving a jump; false if blocked
+        bool forwardLanding(int x, int y, int &toX, int &toY) const
+        {
+            const int player = owner(cell(x, y));
+            const int dx = player == 0 ? 1 : 0;
+            const int dy = player == 1 ? 1 : 0;
+            for (int step = 1; step <= 2; ++step)
+            {
+                toX = x + dx * step;
+                toY = y + dy * step;
+                if (toX >= static_cast<int>(size) || toY >= static_cast<int>(size))
+                    return false;
+                if (owner(cell(toX, toY)) < 0)
+                    return true;
+            }
+            return false;
+        }
+
+        static std::string describe(const Action &action)
+        {
+            std::ostringstream out;
+            out << (action.kind == Action::Move ? "move " : "probe ") << int(action.fromX) << ","
+                << int(action.fromY) << "-" << int(action.toX) << "," << int(action.toY);
+            return out.str();
+        }
+
+        static std::string describe(const MoveResult &result)
+        {
+            std::ostringstream out;
+            out << moveStatusMessage(result.status);
+            if (result.ok())
+                out << " at " << result.x << "," << result.y;
+            return out.str();
+        }
+
+        std::string describeCell(size_t i, uint8_t expected, uint8_t actual) const
+        {
+            std::ostringstream out;
+            out << "cell " << i % size << "," << i / size << " is " << int(expected) << " in the reference but "
+                << int(actual) << " in the candidate";
+            return out.str();
+        }
+
+        // Count a reference cell in or out of the summary
+        void tally(size_t i, uint8_t cell, int sign)
+        {
+            const int player = owner(cell);
+            if (player < 0)
+                return;
+            movable[player] += sign * ((cell & Movable) != 0);
+            scored[player] += sign * ((cell & ReachedEnd) != 0);
+            std::vector<int> &cells = tokenCells[player];
+            if (sign > 0)
+            {
+                tokenSlot[i] = static_cast<int>(cells.size());
+                cells.push_back(static_cast<int>(i));
+            }
+            else
+            {
+                cells[tokenSlot[i]] = cells.back();
+                tokenSlot[cells.back()] = tokenSlot[i];
+                cells.pop_back();
+            }
+        }
+
+        // Whole-board comparison; also rebuilds the summary from scratch
+        std::string compareBoards()
+        {
+            reference.observe(referenceCells);
+            candidate.observe(candidateCells);
+            movable[0] = movable[1] = scored[0] = scored[1] = 0;
+            tokenCells[0].clear();
+            tokenCells[1].clear();
+            tokenSlot.assign(referenceCells.size(), -1);
+            for (size_t i = 0; i < referenceCells.size(); ++i)
+                tally(i, referenceCells[i], 1);
+            if (referenceCells == candidateCells)
+                return {};
+            for (size_t i = 0; i < referenceCells.size(); ++i)
+            {
+                if (referenceCells[i] != candidateCells[i])
+                    return describeCell(i, referenceCells[i], candidateCells[i]);
+            }
+            return "boards differ in size";
+        }
+
+        std::string compareCell(int x, int y)
+        {
+            if (x < 0 || y < 0 || x >= static_cast<int>(size) || y >= static_cast<int>(size))
+                return {};
+            const size_t i = static_cast<size_t>(y) * size + x;
+            const uint8_t expected = reference.observeCell(x, y);
+            const uint8_t actual = candidate.observeCell(x, y);
+            if (expected != referenceCells[i])
+            {
+                tally(i, referenceCells[i], -1);
+                referenceCells[i] = expected;
+                tally(i, expected, 1);
+            }
+            return expected == actual ? std::string() : describeCell(i, expected, actual);
+        }
+
+        /**
+         * Compare the cells a move of player from (x, y) can change: the
+         * square it left, the two squares ahead where it can land, and
+         * the tokens of either player up to two squares behind each of
+         * them, whose movable flags depend on those squares.
+         */
+        std::string compareAround(int x, int y, int player)
+        {
+            const int dx = player == 0 ? 1 : 0;
+            const int dy = player == 1 ? 1 : 0;
+            for (int ahead = 0; ahead <= 2; ++ahead)
+            {
+                const int cellX = x + dx * ahead;
+                const int cellY = y + dy * ahead;
+                for (int behind = 0; behind <= 2; ++behind)
+                {
+                    std::string difference = compareCell(cellX - behind, cellY);
+                    if (difference.empty() && behind > 0)
+                        difference = compareCell(cellX, cellY - behind);
+                    if (!difference.empty())
+                        return difference;
+                }
+            }
+            return {};
+        }
+
+        /**
+         * Send one action to both kernels. Returns a description of any
+         * difference, or empty. valid is cleared for a move the driver
+         * would never make (out of turn); shrinking must skip such
+         * sequences. A move whose target stopped being a forward square
+         * after shrinking is still played, so kernels that disagree about
+         * non-forward targets show up instead of being skipped.
+         */
+        std::string apply(const Action &action, bool &valid)
+        {
+            if (action.kind == Action::Probe)
+            {
+                const MoveResult expected = reference.checkMove(action.fromX, action.fromY, action.toX, action.toY);
+                const MoveResult actual = candidate.checkMove(action.fromX, action.fromY, action.toX, action.toY);
+                if (expected.status != actual.status || (expected.ok() && (expected.x != actual.x || expected.y != actual.y)))
+                    return describe(action) + ": reference " + describe(expected) + ", candidate " + describe(actual);
+                return {};
+            }
+
+            // Moves mirror GameState: only the player to move, and only ever forward
+            const bool inside = action.fromX >= 0 && action.fromY >= 0 && action.fromX < static_cast<int>(size) &&
+                                action.fromY < static_cast<int>(size);
+            if (!inside || owner(cell(action.fromX, action.fromY)) != current)
+            {
+                valid = false;
+                return {};
+            }
+            const MoveStatus referenceStatus = reference.move(action.fromX, action.fromY, action.toX, action.toY);
+            const MoveStatus candidateStatus = candidate.move(action.fromX, action.fromY, action.toX, action.toY);
+            if (referenceStatus != candidateStatus)
+            {
+                return describe(action) + ": reference " + moveStatusMessage(referenceStatus) + ", candidate " +
+                       moveStatusMessage(candidateStatus);
+            }
+            std::string difference = compareAround(action.fromX, action.fromY, current);
+            if (difference.empty() && (++moves % FullCheckInterval == 0 || isOver()))
+                difference = compareBoards();
+            if (!difference.empty())
+                return describe(action) + ": " + difference;
+
+            if (referenceStatus == MoveStatus::Ok && movable[1 - current] > 0)
+                current = 1 - current;
+            return {};
+        }
+    };
+
+    Options options;
+    std::atomic<uint64_t> nextGame{0};
+    std::atomic<uint64_t> movesDone{0};
+    std::atomic<uint64_t> probesDone{0};
+    std::atomic<uint64_t> gamesDone{0};
+    std::atomic<bool> stopRequested{false};
+
+    std::mutex resultMutex;
+    bool found = false;
+    Mismatch firstMismatch;
+    std::vector<Recorded> recorded;
+    std::exception_ptr error;
+
+    size_t pickSize(std::mt19937_64 &rng) const
+    {
+        // Half the games on the smallest boards, where edge and jump cases are densest
+        const size_t smallMax = std::min(options.maxSize, std::max<size_t>(options.minSize, 8));
+        const size_t top = (rng() & 1) ? smallMax : options.maxSize;
+        return options.minSize + rng() % (top - options.minSize + 1);
+    }
+
+    // Play one random game through both kernels, recording its actions
+    std::string playGame(uint64_t game, Replay &replay, std::vector<Action> &actions)
+    {
+        std::mt19937_64 rng(mixHash(options.seed ^ mixHash(game + 1)));
+        const size_t size = pickSize(rng);
+        const int span = static_cast<int>(size) + 2; // Probes reach one square past each side
+        actions.clear();
+        replay.reset(size);
+        std::string difference = replay.compareBoards();
+        if (!difference.empty())
+            return "start position: " + difference;
+
+        std::vector<std::pair<int, int>> own;
+        uint64_t moves = 0, probes = 0;
+        while (!replay.isOver())
+        {
+            for (int probe = static_cast<int>(rng() % 3); probe > 0; --probe)
+            {
+                actions.push_back({Action::Probe, static_cast<int8_t>(rng() % span - 1),
+                                   static_cast<int8_t>(rng() % span - 1), static_cast<int8_t>(rng() % span - 1),
+                                   static_cast<int8_t>(rng() % span - 1)});
+                bool valid = true;
+                difference = replay.apply(actions.back(), valid);
+                ++probes;
+                if (!difference.empty())
+                    break;
+            }
+            if (!difference.empty())
+                break;
+
+            // Usually a movable token; now and then a blocked or scored one to exercise Immovable
+            own.clear();
+            const bool anyToken = rng() % 16 == 0;
+            for (int cell : replay.tokenCells[replay.current])
+            {
+                if (anyToken || (replay.referenceCells[cell] & Movable))
+                    own.push_back({cell % static_cast<int>(size), cell / static_cast<int>(size)});
+            }
+            const auto [x, y] = own[rng() % own.size()];
+            Action move{Action::Move, static_cast<int8_t>(x), static_cast<int8_t>(y),
+                        static_cast<int8_t>(x + (replay.current == 0)), static_cast<int8_t>(y + (replay.current == 1))};
+            int landingX, landingY;
+            if (rng() % 4 == 0 && replay.forwardLanding(x, y, landingX, landingY))
+            {
+                move.toX = static_cast<int8_t>(landingX);
+                move.toY = static_cast<int8_t>(landingY);
+            }
+            actions.push_back(move);
+            bool valid = true;
+            difference = replay.apply(move, valid);
+            ++moves;
+            if (!difference.empty())
+                break;
+        }
+
+        movesDone += moves;
+        probesDone += probes;
+        return difference;
+    }
+
+    // Index of the first action that shows a difference, or -1 (also for invalid sequences)
+    static long firstFailure(Replay &replay, size_t size, const std::vector<Action> &actions)
+    {
+        replay.reset(size);
+        if (!replay.compareBoards().empty())
+            return 0;
+        for (size_t i = 0; i < actions.size(); ++i)
+        {
+            bool valid = true;
+            const std::string difference = replay.apply(actions[i], valid);
+            if (!valid)
+                return -1;
+            if (!difference.empty())
+                return static_cast<long>(i);
+        }
+        // A difference the last full check has not seen yet shows at the end
+        return replay.compareBoards().empty() ? -1 : static_cast<long>(actions.size()) - 1;
+    }
+
+    // Delta debugging: drop ever smaller chunks while the sequence keeps failing
+    static std::vector<Action> shrink(Replay &replay, size_t size, std::vector<Action> actions)
+    {
+        long failure = firstFailure(replay, size, actions);
+        if (failure < 0)
+            return actions;
+        actions.resize(failure + 1);
+
+        size_t chunks = 2;
+        while (actions.size() >= 2)
+        {
+            const size_t chunk = (actions.size() + chunks - 1) / chunks;
+            bool reduced = false;
+            for (size_t start = 0; start < actions.size(); start += chunk)
+            {
+                std::vector<Action> rest(actions.begin(), actions.begin() + start);
+                rest.insert(rest.end(), actions.begin() + std::min(start + chunk, actions.size()), actions.end());
+                failure = firstFailure(replay, size, rest);
+                if (failure >= 0)
+                {
+                    rest.resize(failure + 1);
+                    actions = std::move(rest);
+                    chunks = std::max<size_t>(chunks - 1, 2);
+                    reduced = true;
+                    break;
+                }
+            }
+            if (!reduced)
+            {
+                if (chunks >= actions.size())
+                    break;
+                chunks = std::min(chunks * 2, actions.size());
+            }
+        }
+        return actions;
+    }
+
+    void reportMismatch(uint64_t game, size_t size, const std::vector<Action> &actions)
+    {
+        Replay replay;
+        Mismatch mismatch{game, size, shrink(replay, size, actions), {}};
+
+        // Describe the difference the shrunk sequence ends in
+        replay.reset(size);
+        mismatch.description = replay.compareBoards();
+        for (size_t i = 0; i < mismatch.actions.size() && mismatch.description.empty(); ++i)
+        {
+            bool valid = true;
+            mismatch.description = replay.apply(mismatch.actions[i], valid);
+        }
+        if (mismatch.description.empty())
+            mismatch.description = replay.compareBoards();
+
+        std::lock_guard<std::mutex> lock(resultMutex);
+        if (!found || game < firstMismatch.game)
+            firstMismatch = std::move(mismatch);
+        found = true;
+        stopRequested = true;
+    }
+
+    void workerLoop()
+    {
+        try
+        {
+            Replay replay;
+            std::vector<Action> actions;
+            while (!stopRequested && movesDone < options.moves)
+            {
+                const uint64_t game = nextGame++;
+                const std::string difference = playGame(game, replay, actions);
+                ++gamesDone;
+                if (!difference.empty())
+                {
+                    reportMismatch(game, replay.size, actions);
+                    return;
+                }
+                if (game < options.benchmarkGames)
+                {
+                    std::lock_guard<std::mutex> lock(resultMutex);
+                    recorded[game] = {replay.size, actions};
+                }
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(resultMutex);
+            if (!error)
+                error = std::current_exception();
+            stopRequested = true;
+        }
+    }
+
+    // Best of three timed replays of every recorded game on one kernel alone
+    template <class Kernel>
+    double actionsPerSecond() const
+    {
+        Kernel kernel;
+        uint64_t actions = 0;
+        double best = 0;
+        for (int round = 0; round < 3; ++round)
+        {
+            const auto startTime = std::chrono::steady_clock::now();
+            actions = 0;
+            for (const Recorded &game : recorded)
+            {
+                if (game.actions.empty())
+                    continue;
+                kernel.reset(game.boardSize);
+                for (const Action &action : game.actions)
+                {
+                    if (action.kind == Action::Move)
+                        kernel.move(action.fromX, action.fromY, action.toX, action.toY);
+                    else
+                        kernel.checkMove(action.fromX, action.fromY, action.toX, action.toY);
+                }
+                actions += game.actions.size();
+            }
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+            best = std::max(best, actions / std::max(seconds, 1e-9));
+        }
+        return best;
+    }
+
+public:
+    explicit DifferentialHarness(const Options &harnessOptions) : options(harnessOptions)
+    {
+        if (options.minSize < 3 || options.maxSize - 2 > Position::MaxMoves || options.minSize > options.maxSize)
+            throw std::runtime_error("Board sizes must lie between 3 and 51");
+        options.threads = std::max(options.threads, 1u);
+    }
+
+    // May be called from another thread or a signal handler
+    void stop() { stopRequested = true; }
+
+    Report run(const ProgressCallback &onProgress = {})
+    {
+        const auto startTime = std::chrono::steady_clock::now();
+        recorded.assign(options.benchmarkGames, Recorded{0, {}});
+
+        std::vector<std::thread> workers;
+        for (unsigned i = 0; i < options.threads; ++i)
+            workers.emplace_back(&DifferentialHarness::workerLoop, this);
+
+        auto elapsed = [&]
+        { return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count(); };
+        while (onProgress && !stopRequested && movesDone < options.moves)
+        {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            onProgress({gamesDone, movesDone, probesDone, elapsed()});
+        }
+        for (std::thread &worker : workers)
+            worker.join();
+        if (error)
+            std::rethrow_exception(error);
+
+        Report report;
+        report.games = gamesDone;
+        report.moves = movesDone;
+        report.probes = probesDone;
+        report.seconds = elapsed();
+        report.passed = !found;
+        report.mismatch = firstMismatch;
+        if (report.passed)
+        {
+            report.referenceActionsPerSecond = actionsPerSecond<Reference>();
+            report.candidateActionsPerSecond = actionsPerSecond<Candidate>();
+        }
+        return report;
+    }
+
+    static std::string describe(const Action &action) { return Replay::describe(action); }
+};
+
+#endif // RULESHARNESS_H
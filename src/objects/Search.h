@@ -0,0 +1,463 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "AnalysisCache.h"
+#include "Evaluator.h"
+#include "Position.h"
+#include "SearchTrace.h"
+
+/**
+ * Iterative-deepening alpha-beta search over Positions.
+ *
+ * Scores are from the point of view of the side to move. Because a player
+ * with no movable token is skipped, consecutive plies can belong to the
+ * same side; such children are searched without negating the window.
+ */
+class Search
+{
+public:
+    static constexpr int MateScore = 100000;
+    static constexpr int Infinity = MateScore + 1;
+
+    struct Limits
+    {
+        int depth = 0;         // 0 means no depth limit
+        uint64_t nodes = 0;    // 0 means no node limit
+        int64_t movetimeMs = 0; // Hard deadline; 0 means no time limit
+        int64_t softTimeMs = 0; // No new iteration is started past half of this; 0 means none
+
+        // Optional flag owned by the caller; the search ends once it is set
+        const std::atomic<bool> *stop = nullptr;
+    };
+
+    struct Info
+    {
+        int depth = 0;
+        int score = 0;
+        uint64_t nodes = 0;
+        double seconds = 0;
+        Move bestMove{0, 0, 0};
+        bool hasMove = false;
+    };
+
+    using InfoCallback = std::function<void(const Info &)>;
+
+private:
+    enum Bound : uint8_t
+    {
+        Exact,
+        Lower,
+        Upper
+    };
+
+    struct Entry
+    {
+        uint64_t hash;
+        int32_t score;
+        int16_t depth;
+        uint8_t bound;
+        uint8_t used;
+        Move move;
+    };
+
+    std::vector<Entry> table;
+    size_t tableMask;
+    AnalysisCache *persistent = nullptr;
+    Evaluator::Weights evalWeights = Evaluator::DefaultWeights;
+
+    // Shallower results are cheap to recompute and would churn the shared file
+    static constexpr int PersistentMinDepth = 4;
+
+    bool stopRequested = false;
+    uint64_t nodes = 0;
+    Limits limits;
+    std::chrono::steady_clock::time_point startTime;
+
+    // Optional node trace; the clock is only read when limits are checked
+    SearchTrace::Writer *trace = nullptr;
+    uint32_t traceMicros = 0;
+    uint16_t traceRun = 0;
+    Move traceMove{0, 0, 0}; // Move into the node being entered
+
+    // Why a node returned what it did, for the trace
+    struct NodeOutcome
+    {
+        SearchTrace::Reason reason = SearchTrace::Leaf;
+        int moves = 0;
+        int searched = 0;
+    };
+
+    double elapsedSeconds() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    }
+
+    void checkLimits()
+    {
+        if (limits.stop && limits.stop->load(std::memory_order_relaxed))
+            stopRequested = true;
+        if (limits.nodes != 0 && nodes >= limits.nodes)
+            stopRequested = true;
+        if (limits.movetimeMs != 0 && elapsedSeconds() * 1000.0 >= static_cast<double>(limits.movetimeMs))
+            stopRequested = true;
+        if (trace)
+            traceMicros = static_cast<uint32_t>(elapsedSeconds() * 1e6);
+    }
+
+    void traceNode(const Position &pos, const Move &move, int depth, int alpha, int beta, int score, int ply,
+                   uint64_t subtreeNodes, const NodeOutcome &outcome)
+    {
+        trace->append({pos.getHash(), alpha, beta, score, static_cast<uint32_t>(subtreeNodes), traceMicros,
+                       move.from, move.to, static_cast<uint8_t>(std::min(ply, 255)),
+                       static_cast<int8_t>(std::clamp(depth, -128, 127)), static_cast<uint8_t>(outcome.reason),
+                       static_cast<uint8_t>(outcome.moves), static_cast<uint8_t>(outcome.searched),
+                       static_cast<uint8_t>(pos.getSize()), traceRun});
+    }
+
+    static int terminalScore(const Position &pos, int ply)
+    {
+        const int winner = pos.winner();
+        if (winner < 0)
+            return 0;
+        return winner == pos.getSideToMove() ? MateScore - ply : -(MateScore - ply);
+    }
+
+    // Mate scores are stored relative to the node so they stay valid at any ply
+    static int toTable(int score, int ply)
+    {
+        if (score > MateScore - 1000)
+            return score + ply;
+        if (score < -(MateScore - 1000))
+            return score - ply;
+        return score;
+    }
+
+    static int fromTable(int score, int ply)
+    {
+        if (score > MateScore - 1000)
+            return score - ply;
+        if (score < -(MateScore - 1000))
+            return score + ply;
+        return score;
+    }
+
+    static bool sameMove(const Move &a, const Move &b)
+    {
+        return a.from == b.from && a.to == b.to;
+    }
+
+    // Put the table move first, then jumps and scoring moves
+    static void orderMoves(const Position &pos, Move *moves, int count, const Move *tableMove)
+    {
+        const BoardGrid &grid = pos.getGrid();
+        const size_t step = grid.forwardOffset(pos.getSideToMove());
+        auto priority = [&](const Move &move)
+        {
+            if (tableMove && sameMove(move, *tableMove))
+                return 3;
+            if (grid.isEdge(move.to))
+                return 2;
+            return static_cast<size_t>(move.to - move.from) != step ? 1 : 0;
+        };
+        std::stable_sort(moves, moves + count, [&](const Move &a, const Move &b)
+                         { return priority(a) > priority(b); });
+    }
+
+    Entry &slot(uint64_t hash)
+    {
+        return table[hash & tableMask];
+    }
+
+    void store(uint64_t hash, int depth, int score, Bound bound, const Move &move, int ply)
+    {
+        if (persistent && depth >= PersistentMinDepth)
+        {
+            persistent->store(hash, {toTable(score, ply), static_cast<uint16_t>(depth),
+                                     static_cast<uint8_t>(bound), AnalysisCache::SearchScore});
+        }
+
+        Entry &entry = slot(hash);
+        if (entry.used && entry.hash != hash && entry.depth > depth)
+            return;
+        entry = {hash, toTable(score, ply), static_cast<int16_t>(depth),
+                 static_cast<uint8_t>(bound), 1, move};
+    }
+
+    static bool cutsOff(uint8_t bound, int score, int alpha, int beta)
+    {
+        return bound == Exact ||
+               (bound == Lower && score >= beta) ||
+               (bound == Upper && score <= alpha);
+    }
+
+    // Score of a child, flipping the window only when the side to move changed
+    int searchChild(Position &pos, const Move &move, int depth, int alpha, int beta, int ply)
+    {
+        const int side = pos.getSideToMove();
+        traceMove = move;
+        const Position::Undo undo = pos.makeMove(move);
+        const int score = pos.getSideToMove() == side
+                              ? negamax(pos, depth - 1, alpha, beta, ply + 1)
+                              : -negamax(pos, depth - 1, -beta, -alpha, ply + 1);
+        pos.unmakeMove(undo);
+        return score;
+    }
+
+    int negamax(Position &pos, int depth, int alpha, int beta, int ply)
+    {
+        NodeOutcome outcome;
+        if (!trace)
+            return visit(pos, depth, alpha, beta, ply, outcome);
+
+        const Move move = traceMove;
+        const uint64_t before = nodes;
+        const int score = visit(pos, depth, alpha, beta, ply, outcome);
+        traceNode(pos, move, depth, alpha, beta, score, ply, nodes - before, outcome);
+        return score;
+    }
+
+    int visit(Position &pos, int depth, int alpha, int beta, int ply, NodeOutcome &outcome)
+    {
+        // Often enough to stop within a fraction of a millisecond even on 51x51 boards
+        if ((++nodes & 31) == 0)
+            checkLimits();
+        if (stopRequested)
+        {
+            outcome.reason = SearchTrace::Stopped;
+            return 0;
+        }
+
+        if (pos.isGameOver())
+        {
+            outcome.reason = SearchTrace::Terminal;
+            return terminalScore(pos, ply);
+        }
+        if (depth <= 0)
+            return Evaluator::evaluate(pos, evalWeights);
+
+        const uint64_t hash = pos.getHash();
+        const Entry &entry = slot(hash);
+        const Move *tableMove = nullptr;
+        if (entry.used && entry.hash == hash)
+        {
+            tableMove = &entry.move;
+            if (entry.depth >= depth && cutsOff(entry.bound, fromTable(entry.score, ply), alpha, beta))
+            {
+                outcome.reason = SearchTrace::TableCut;
+                return fromTable(entry.score, ply);
+            }
+        }
+        else if (persistent && depth >= PersistentMinDepth)
+        {
+            AnalysisCache::Value cached;
+            if (persistent->probe(hash, cached) && cached.kind == AnalysisCache::SearchScore &&
+                cached.depth >= depth && cutsOff(cached.bound, fromTable(cached.score, ply), alpha, beta))
+            {
+                outcome.reason = SearchTrace::PersistentCut;
+                return fromTable(cached.score, ply);
+            }
+        }
+
+        Move moves[Position::MaxMoves];
+        const int count = pos.generateMoves(moves);
+        orderMoves(pos, moves, count, tableMove);
+        outcome.moves = count;
+
+        const int originalAlpha = alpha;
+        int best = -Infinity;
+        Move bestMove = moves[0];
+        for (int i = 0; i < count; ++i)
+        {
+            const int score = searchChild(pos, moves[i], depth, alpha, beta, ply);
+            outcome.searched = i + 1;
+            if (stopRequested)
+            {
+                outcome.reason = SearchTrace::Stopped;
+                return 0;
+            }
+
+            if (score > best)
+            {
+                best = score;
+                bestMove = moves[i];
+            }
+            alpha = std::max(alpha, score);
+            if (alpha >= beta)
+                break;
+        }
+
+        const Bound bound = best <= originalAlpha ? Upper : (best >= beta ? Lower : Exact);
+        outcome.reason = bound == Upper ? SearchTrace::AllNode : (bound == Lower ? SearchTrace::BetaCut : SearchTrace::ExactNode);
+        store(hash, depth, best, bound, bestMove, ply);
+        return best;
+    }
+
+public:
+    explicit Search(size_t tableMegabytes)
+    {
+        resize(tableMegabytes);
+    }
+
+    Search(const Search &) = delete;
+    Search &operator=(const Search &) = delete;
+
+    void resize(size_t tableMegabytes)
+    {
+        resizeBytes(tableMegabytes * 1024 * 1024);
+    }
+
+    // Largest power-of-two table that fits in bytes, with at least one entry
+    void resizeBytes(size_t bytes)
+    {
+        size_t entries = 1;
+        const size_t wanted = std::max<size_t>(bytes / sizeof(Entry), 1);
+        while (entries * 2 <= wanted)
+            entries *= 2;
+        table.assign(entries, Entry{});
+        table.shrink_to_fit();
+        tableMask = entries - 1;
+    }
+
+    size_t getTableBytes() const { return table.capacity() * sizeof(Entry); }
+
+    // Evaluate leaves with other weights, e.g. candidates being tuned
+    void setEvalWeights(const Evaluator::Weights &weights) { evalWeights = weights; }
+
+    // Share results with other processes and runs through a persistent cache
+    void setPersistentCache(AnalysisCache *cache) { persistent = cache; }
+
+    // Record every visited node; the writer must belong to the thread running this search
+    void setTrace(SearchTrace::Writer *writer) { trace = writer; }
+
+    void clear()
+    {
+        std::fill(table.begin(), table.end(), Entry{});
+    }
+
+    /**
+     * Search until a limit is hit or the caller's stop flag is set.
+     * onIteration is called after every completed depth; the returned Info
+     * is the deepest one.
+     */
+    Info run(const Position &start, const Limits &searchLimits, const InfoCallback &onIteration = {})
+    {
+        Position pos = start;
+        limits = searchLimits;
+        nodes = 0;
+        stopRequested = false;
+        startTime = std::chrono::steady_clock::now();
+        checkLimits();
+
+        Info result;
+        Move moves[Position::MaxMoves];
+        const int count = pos.isGameOver() ? 0 : pos.generateMoves(moves);
+        if (trace)
+        {
+            ++traceRun;
+            traceMicros = 0;
+            NodeOutcome start{SearchTrace::RunStart, count, 0};
+            traceNode(pos, {0, 0, 0}, limits.depth, -Infinity, Infinity, 0, 0, 0, start);
+        }
+        if (count == 0)
+        {
+            if (trace)
+                trace->flush();
+            return result;
+        }
+
+        result.bestMove = moves[0];
+        result.hasMove = true;
+
+        const int maxDepth = limits.depth > 0 ? limits.depth : 1000;
+        for (int depth = 1; depth <= maxDepth; ++depth)
+        {
+            const Entry &entry = slot(pos.getHash());
+            const bool hasTableMove = entry.used && entry.hash == pos.getHash();
+            orderMoves(pos, moves, count, hasTableMove ? &entry.move : nullptr);
+
+            int alpha = -Infinity;
+            Move bestMove = moves[0];
+            int searched = 0;
+            for (int i = 0; i < count; ++i)
+            {
+                const int score = searchChild(pos, moves[i], depth, alpha, Infinity, 0);
+                if (stopRequested)
+                    break;
+                ++searched;
+                if (score > alpha)
+                {
+                    alpha = score;
+                    bestMove = moves[i];
+                }
+            }
+
+            if (stopRequested)
+            {
+                // The previous best is searched first, so a move that beat it in
+                // the interrupted iteration is better founded than the old choice
+                if (searched > 1 && !sameMove(bestMove, moves[0]))
+                    result.bestMove = bestMove;
+                break;
+            }
+
+            store(pos.getHash(), depth, alpha, Exact, bestMove, 0);
+            if (trace)
+            {
+                NodeOutcome iteration{SearchTrace::Iteration, count, searched};
+                traceNode(pos, bestMove, depth, -Infinity, Infinity, alpha, 0, nodes - result.nodes, iteration);
+            }
+            result.depth = depth;
+            result.score = alpha;
+            result.bestMove = bestMove;
+            result.nodes = nodes;
+            result.seconds = elapsedSeconds();
+            if (onIteration)
+                onIteration(result);
+
+            // A proven result will not change with more depth
+            if (alpha > MateScore - 1000 || alpha < -(MateScore - 1000))
+                break;
+
+            // The next iteration would most likely not finish in the remaining time
+            if (limits.softTimeMs != 0 && elapsedSeconds() * 1000.0 * 2 >= static_cast<double>(limits.softTimeMs))
+                break;
+        }
+
+        result.nodes = nodes;
+        result.seconds = elapsedSeconds();
+        if (trace)
+            trace->flush();
+        return result;
+    }
+
+    // Number of leaf positions exactly depth plies ahead
+    static uint64_t perft(Position &pos, int depth)
+    {
+        if (depth == 0)
+            return 1;
+        if (pos.isGameOver())
+            return 0;
+
+        Move moves[Position::MaxMoves];
+        const int count = pos.generateMoves(moves);
+        if (depth == 1)
+            return count;
+
+        uint64_t total = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            const Position::Undo undo = pos.makeMove(moves[i]);
+            total += perft(pos, depth - 1);
+            pos.unmakeMove(undo);
+        }
+        return total;
+    }
+};
+
+#endif // SEARCH_H
@@ -0,0 +1,277 @@
+#ifndef SEARCHTRACE_H
+#define SEARCHTRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Binary trace of every node a Search visits, for offline analysis.
+ *
+ * Each searching thread gets a Writer that fills fixed blocks of records
+ * without locking. Full blocks go through a single-producer ring to a
+ * background thread, which appends them to the file and hands them back
+ * through a second ring. A writer only waits if it gets a whole buffer
+ * set ahead of the disk.
+ *
+ * File layout: "GTTR", version, three zero bytes, then chunks of
+ * u32 writer, u32 record count and that many Records, in host byte order.
+ * A writer's chunks are in visit order; chunks of different writers
+ * interleave. Nodes are recorded when they return, so a node's record
+ * follows those of its whole subtree.
+ */
+class SearchTrace
+{
+public:
+    static constexpr uint8_t Version = 1;
+    static constexpr size_t BlockRecords = 1632; // About 64 KB per block
+    static constexpr size_t BlocksPerWriter = 32;
+
+    enum Reason : uint8_t
+    {
+        RunStart,      // One per Search::run; depth is the depth limit
+        Iteration,     // Root after each completed depth
+        Terminal,      // Game over
+        Leaf,          // Static evaluation at depth 0
+        TableCut,      // Transposition table bound
+        PersistentCut, // Persistent cache bound
+        BetaCut,       // A child reached beta
+        AllNode,       // No child raised alpha
+        ExactNode,     // Score inside the window
+        Stopped,       // Search aborted in this node
+        ReasonCount
+    };
+
+    struct Record
+    {
+        uint64_t hash;
+        int32_t alpha; // Window on entry
+        int32_t beta;
+        int32_t score;
+        uint32_t subtreeNodes; // This node and everything below it
+        uint32_t micros;       // Since the run started, updated every 32 nodes
+        uint16_t from;         // Move into the node, as grid indices
+        uint16_t to;
+        uint8_t ply;
+        int8_t depth;     // Remaining depth
+        uint8_t reason;
+        uint8_t moves;    // Legal moves at the node
+        uint8_t searched; // Children searched
+        uint8_t boardSize;
+        uint16_t run;     // Search::run number within the writer
+    };
+    static_assert(sizeof(Record) == 40, "trace records are written as is");
+
+private:
+    struct Block
+    {
+        uint32_t count = 0;
+        Record records[BlockRecords];
+    };
+
+    // Single-producer single-consumer ring of block pointers
+    class BlockRing
+    {
+    private:
+        Block *slots[BlocksPerWriter];
+        std::atomic<size_t> head{0};
+        std::atomic<size_t> tail{0};
+
+    public:
+        bool push(Block *block)
+        {
+            const size_t end = tail.load(std::memory_order_relaxed);
+            if (end - head.load(std::memory_order_acquire) == BlocksPerWriter)
+                return false;
+            slots[end % BlocksPerWriter] = block;
+            tail.store(end + 1, std::memory_order_release);
+            return true;
+        }
+
+        Block *pop()
+        {
+            const size_t start = head.load(std::memory_order_relaxed);
+            if (start == tail.load(std::memory_order_acquire))
+                return nullptr;
+            Block *block = slots[start % BlocksPerWriter];
+            head.store(start + 1, std::memory_order_release);
+            return block;
+        }
+    };
+
+public:
+    // Record buffer of one searching thread; only that thread may call append() and flush()
+    class Writer
+    {
+    private:
+        friend class SearchTrace;
+
+        SearchTrace &owner;
+        uint32_t id;
+        std::vector<std::unique_ptr<Block>> storage;
+        BlockRing filled; // To the flusher
+        BlockRing empty;  // Back from the flusher
+        Block *current;
+        uint64_t waits = 0;
+
+        void submit()
+        {
+            filled.push(current); // Cannot fail: there are only BlocksPerWriter blocks
+            owner.wake();
+            while (!(current = empty.pop()))
+            {
+                ++waits;
+                owner.wake();
+                std::this_thread::yield();
+            }
+            current->count = 0;
+        }
+
+    public:
+        Writer(SearchTrace &trace, uint32_t writerId) : owner(trace), id(writerId)
+        {
+            for (size_t i = 0; i < BlocksPerWriter; ++i)
+                storage.push_back(std::make_unique<Block>());
+            current = storage[0].get();
+            for (size_t i = 1; i < BlocksPerWriter; ++i)
+                empty.push(storage[i].get());
+        }
+
+        void append(const Record &record)
+        {
+            if (current->count == BlockRecords)
+                submit();
+            current->records[current->count++] = record;
+        }
+
+        // Hand over a partly filled block, e.g. at the end of a search
+        void flush()
+        {
+            if (current->count)
+                submit();
+        }
+
+        // Times the thread had to wait for the disk
+        uint64_t getWaits() const { return waits; }
+    };
+
+private:
+    std::FILE *file;
+    std::vector<std::unique_ptr<Writer>> writers;
+    std::mutex mutex;
+    std::condition_variable blockReady;
+    bool quit = false;
+    std::atomic<uint64_t> bytesWritten{0};
+    std::thread flusher;
+
+    void wake() { blockReady.notify_one(); }
+
+    // Write every block the writers have handed over; false if there was none
+    bool drain(const std::vector<Writer *> &snapshot)
+    {
+        bool any = false;
+        for (Writer *writer : snapshot)
+        {
+            while (Block *block = writer->filled.pop())
+            {
+                const uint32_t header[2] = {writer->id, block->count};
+                std::fwrite(header, sizeof(header), 1, file);
+                std::fwrite(block->records, sizeof(Record), block->count, file);
+                bytesWritten += sizeof(header) + sizeof(Record) * block->count;
+                writer->empty.push(block);
+                any = true;
+            }
+        }
+        return any;
+    }
+
+    void flushLoop()
+    {
+        std::vector<Writer *> snapshot;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            const bool stopping = quit;
+            snapshot.clear();
+            for (const auto &writer : writers)
+                snapshot.push_back(writer.get());
+            lock.unlock();
+            const bool wrote = drain(snapshot);
+            lock.lock();
+            if (stopping)
+                return;
+            if (!wrote)
+                blockReady.wait_for(lock, std::chrono::milliseconds(5));
+        }
+    }
+
+public:
+    explicit SearchTrace(const std::string &path) : file(std::fopen(path.c_str(), "wb"))
+    {
+        if (!file)
+            throw std::runtime_error("Failed to create " + path);
+        const char header[8] = {'G', 'T', 'T', 'R', static_cast<char>(Version), 0, 0, 0};
+        std::fwrite(header, sizeof(header), 1, file);
+        bytesWritten = sizeof(header);
+        flusher = std::thread(&SearchTrace::flushLoop, this);
+    }
+
+    // Writers must be flushed and no longer in use
+    ~SearchTrace()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+        }
+        blockReady.notify_one();
+        flusher.join();
+        std::fclose(file);
+    }
+
+    SearchTrace(const SearchTrace &) = delete;
+    SearchTrace &operator=(const SearchTrace &) = delete;
+
+    // A new per-thread buffer; it lives as long as the trace
+    Writer *createWriter()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        writers.push_back(std::make_unique<Writer>(*this, static_cast<uint32_t>(writers.size())));
+        return writers.back().get();
+    }
+
+    uint64_t getBytesWritten() const { return bytesWritten; }
+
+    // Streams a trace file chunk by chunk; calls onRecord(writer, record) for every record
+    template <class Callback>
+    static void read(const std::string &path, Callback onRecord)
+    {
+        std::unique_ptr<std::FILE, int (*)(std::FILE *)> in(std::fopen(path.c_str(), "rb"), std::fclose);
+        if (!in)
+            throw std::runtime_error("Failed to open " + path);
+        char header[8];
+        if (std::fread(header, sizeof(header), 1, in.get()) != 1 || std::string(header, 4) != "GTTR")
+            throw std::runtime_error("Not a search trace: " + path);
+        if (static_cast<uint8_t>(header[4]) != Version)
+            throw std::runtime_error("Unsupported trace version");
+
+        std::vector<Record> records(BlockRecords);
+        uint32_t chunk[2];
+        while (std::fread(chunk, sizeof(chunk), 1, in.get()) == 1)
+        {
+            if (chunk[1] > BlockRecords || std::fread(records.data(), sizeof(Record), chunk[1], in.get()) != chunk[1])
+                throw std::runtime_error("Truncated trace: " + path);
+            for (uint32_t i = 0; i < chunk[1]; ++i)
+                onRecord(chunk[0], records[i]);
+        }
+    }
+};
+
+#endif // SEARCHTRACE_H
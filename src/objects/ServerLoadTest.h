@@ -0,0 +1,377 @@
+#ifndef SERVERLOADTEST_H
+#define SERVERLOADTEST_H
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "GameProtocol.h"
+#include "LineSocket.h"
+
+/**
+ * Load generator and checker for GameServer.
+ *
+ * Keeps a fixed number of sessions live over a few connections, playing
+ * random moves and starting a new game whenever one ends. Every game is
+ * mirrored in a local Position and every Moved event, including the
+ * server's own moves, must match it. Some sessions play against the
+ * server so its search runs alongside plain move validation.
+ */
+class ServerLoadTest
+{
+public:
+    using MessageType = GameProtocol::MessageType;
+    using LatencyHistogram = GameProtocol::LatencyHistogram;
+
+    struct Options
+    {
+        std::string address = "127.0.0.1"; // Host name, or a Unix socket path if it contains '/'
+        uint16_t port = 7411;
+        size_t sessions = 10000;
+        size_t connections = 16;
+        double seconds = 10;
+        size_t boardSize = 9;
+        size_t computerEvery = 4; // Every n-th session plays the server; 0 for none
+        uint8_t depth = 2;        // Search depth of the server's moves
+        uint64_t seed = 1;
+    };
+
+    struct Report
+    {
+        double seconds = 0;
+        uint64_t games = 0;
+        uint64_t moves = 0;       // Client and server moves
+        uint64_t errors = 0;      // Error replies
+        uint64_t mismatches = 0;  // Moved events that disagree with the mirror
+        size_t peakSessions = 0;
+        LatencyHistogram roundTrip; // Client move to its Moved event, microseconds
+        uint32_t server[5] = {0, 0, 0, 0, 0}; // Server latency: count p50 p90 p99 max
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Game
+    {
+        uint32_t id = 0;
+        size_t connection;
+        uint8_t computers;
+        bool waiting = false; // A move of ours is in flight
+        bool closing = false; // Close sent; later events are ignored
+        Clock::time_point sent;
+        Position position;
+
+        Game(size_t conn, uint8_t computerMask, size_t size)
+            : connection(conn), computers(computerMask), position(size) {}
+    };
+
+    struct Link
+    {
+        int fd;
+        std::string input;
+        std::string output;
+    };
+
+    Options options;
+    std::vector<Link> links;
+    std::vector<Game> games;
+    std::unordered_map<uint32_t, size_t> bySession;
+    std::mt19937_64 rng;
+    Report report;
+    size_t live = 0;
+    bool draining = false;
+    bool gotServerLatency = false;
+
+    int connectOne() const
+    {
+        if (options.address.find('/') == std::string::npos)
+        {
+            LineSocket socket = LineSocket::connectTo(options.address, options.port);
+            const int fd = dup(socket.getFd());
+            if (fd < 0)
+                throw std::runtime_error("Cannot duplicate socket");
+            return fd;
+        }
+
+        sockaddr_un address{};
+        if (options.address.size() >= sizeof(address.sun_path))
+            throw std::runtime_error("Unix socket path too long: " + options.address);
+        address.sun_family = AF_UNIX;
+        std::strcpy(address.sun_path, options.address.c_str());
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+        {
+            if (fd >= 0)
+                close(fd);
+            throw std::runtime_error("Cannot connect to " + options.address);
+        }
+        return fd;
+    }
+
+    void create(size_t index)
+    {
+        Game &game = games[index];
+        game.position = Position(options.boardSize);
+        game.waiting = false;
+        game.closing = false;
+        GameProtocol::FrameWriter(links[game.connection].output, MessageType::Create)
+            .u32(static_cast<uint32_t>(index))
+            .u8(static_cast<uint8_t>(options.boardSize))
+            .u8(game.computers)
+            .u8(options.depth);
+    }
+
+    bool clientToMove(const Game &game) const
+    {
+        return !game.position.isGameOver() && !((game.computers >> game.position.getSideToMove()) & 1);
+    }
+
+    // Random legal move, aimed at the landing square or, as a click would be, at the square in front
+    void sendMove(Game &game)
+    {
+        Move moves[Position::MaxMoves];
+        const int count = game.position.generateMoves(moves);
+        const Move &move = moves[rng() % count];
+        const BoardGrid &grid = game.position.getGrid();
+        const size_t target = (rng() & 1) ? move.to : move.from + grid.forwardOffset(game.position.getSideToMove());
+        GameProtocol::FrameWriter(links[game.connection].output, MessageType::Move)
+            .u32(game.id)
+            .u8(grid.column(move.from))
+            .u8(grid.row(move.from))
+            .u8(grid.column(target))
+            .u8(grid.row(target));
+        game.waiting = true;
+        game.sent = Clock::now();
+    }
+
+    void closeGame(Game &game)
+    {
+        GameProtocol::FrameWriter(links[game.connection].output, MessageType::Close).u32(game.id);
+        game.closing = true;
+    }
+
+    // Keep the game going, or end it
+    void advance(Game &game)
+    {
+        if (game.closing)
+            return;
+        if (game.position.isGameOver() || draining)
+        {
+            closeGame(game);
+        }
+        else if (!game.waiting && clientToMove(game))
+        {
+            sendMove(game);
+        }
+    }
+
+    void onMoved(GameProtocol::FrameReader &fields)
+    {
+        const uint32_t id = fields.u32();
+        uint8_t value[8];
+        for (uint8_t &field : value)
+            field = fields.u8();
+        auto found = bySession.find(id);
+        if (!fields.ok() || found == bySession.end())
+        {
+            ++report.mismatches;
+            return;
+        }
+
+        Game &game = games[found->second];
+        if (game.closing)
+            return;
+        const bool ours = !((game.computers >> game.position.getSideToMove()) & 1);
+        const BoardGrid &grid = game.position.getGrid();
+        Move move;
+        if (!game.position.findMove(value[0], value[1], value[2], value[3], move) ||
+            grid.column(move.to) != value[2] || grid.row(move.to) != value[3])
+        {
+            ++report.mismatches;
+            return;
+        }
+        game.position.makeMove(move);
+        ++report.moves;
+        const Position &pos = game.position;
+        if (pos.getSideToMove() != value[4] || pos.getScore(0) != value[5] || pos.getScore(1) != value[6] ||
+            static_cast<uint8_t>(GameProtocol::statusOf(pos)) != value[7])
+        {
+            ++report.mismatches;
+        }
+
+        if (ours && game.waiting)
+        {
+            report.roundTrip.record(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - game.sent).count());
+            game.waiting = false;
+        }
+        advance(game);
+    }
+
+    void handleFrame(MessageType type, GameProtocol::FrameReader &fields)
+    {
+        switch (type)
+        {
+        case MessageType::Created:
+        {
+            const uint32_t tag = fields.u32();
+            const uint32_t id = fields.u32();
+            if (!fields.ok() || tag >= games.size())
+            {
+                ++report.mismatches;
+                return;
+            }
+            Game &game = games[tag];
+            game.id = id;
+            bySession[id] = tag;
+            advance(game);
+            break;
+        }
+
+        case MessageType::Moved:
+            onMoved(fields);
+            break;
+
+        case MessageType::Closed:
+        {
+            auto found = bySession.find(fields.u32());
+            if (found == bySession.end())
+                return;
+            const size_t index = found->second;
+            bySession.erase(found);
+            if (games[index].position.isGameOver())
+                ++report.games;
+            if (draining)
+                --live;
+            else
+                create(index);
+            break;
+        }
+
+        case MessageType::LatencyReport:
+            fields.u32();
+            for (uint32_t &value : report.server)
+                value = fields.u32();
+            gotServerLatency = true;
+            break;
+
+        case MessageType::Error:
+        {
+            // The mirror cannot be trusted after an error, so the game is given up
+            ++report.errors;
+            const uint32_t id = fields.u32();
+            const MessageType request = static_cast<MessageType>(fields.u8());
+            if (request == MessageType::Create)
+            {
+                --live;
+                break;
+            }
+            auto found = bySession.find(id);
+            if (found != bySession.end() && !games[found->second].closing)
+                closeGame(games[found->second]);
+            break;
+        }
+
+        default:
+            ++report.mismatches;
+            break;
+        }
+    }
+
+    // Send what the socket takes and read whatever has arrived; false if the server went away
+    bool service(Link &link, short revents)
+    {
+        if (!link.output.empty())
+        {
+            const ssize_t count = send(link.fd, link.output.data(), link.output.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+                return false;
+            if (count > 0)
+                link.output.erase(0, static_cast<size_t>(count));
+        }
+        if (!(revents & (POLLIN | POLLHUP | POLLERR)))
+            return true;
+
+        char chunk[65536];
+        const ssize_t count = recv(link.fd, chunk, sizeof(chunk), MSG_DONTWAIT);
+        if (count == 0 || (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+            return false;
+        if (count > 0)
+            link.input.append(chunk, static_cast<size_t>(count));
+
+        size_t offset = 0;
+        MessageType type;
+        GameProtocol::FrameReader fields(nullptr, 0);
+        while (GameProtocol::nextFrame(link.input, offset, type, fields))
+            handleFrame(type, fields);
+        link.input.erase(0, offset);
+        return true;
+    }
+
+public:
+    explicit ServerLoadTest(const Options &testOptions) : options(testOptions), rng(testOptions.seed) {}
+
+    ~ServerLoadTest()
+    {
+        for (Link &link : links)
+            close(link.fd);
+    }
+
+    ServerLoadTest(const ServerLoadTest &) = delete;
+    ServerLoadTest &operator=(const ServerLoadTest &) = delete;
+
+    Report run()
+    {
+        if (options.boardSize < 3 || options.boardSize - 2 > Position::MaxMoves)
+            throw std::runtime_error("Board size must be between 3 and 51");
+        const auto startTime = Clock::now();
+        const size_t connectionCount = std::max<size_t>(1, std::min(options.connections, options.sessions));
+        for (size_t i = 0; i < connectionCount; ++i)
+            links.push_back({connectOne(), {}, {}});
+
+        for (size_t i = 0; i < options.sessions; ++i)
+        {
+            // Computer sessions alternate between the server opening and the server replying
+            const bool computer = options.computerEvery && i % options.computerEvery == 0;
+            const uint8_t computers = computer ? ((i / options.computerEvery) % 2 ? 1 : 2) : 0;
+            games.emplace_back(i % connectionCount, computers, options.boardSize);
+            create(i);
+        }
+        live = options.sessions;
+
+        std::vector<pollfd> fds(links.size());
+        while (live > 0 || !gotServerLatency)
+        {
+            if (!draining && Clock::now() - startTime >= std::chrono::duration<double>(options.seconds))
+            {
+                // Close every game at its next reply, then ask for the server's own numbers
+                draining = true;
+                GameProtocol::FrameWriter(links[0].output, MessageType::Latency).u32(0);
+            }
+            report.peakSessions = std::max(report.peakSessions, bySession.size());
+
+            for (size_t i = 0; i < links.size(); ++i)
+                fds[i] = {links[i].fd, static_cast<short>(POLLIN | (links[i].output.empty() ? 0 : POLLOUT)), 0};
+            if (poll(fds.data(), fds.size(), 100) < 0 && errno != EINTR)
+                throw std::runtime_error("poll failed");
+            for (size_t i = 0; i < links.size(); ++i)
+            {
+                if (!service(links[i], fds[i].revents))
+                    throw std::runtime_error("Server closed the connection");
+            }
+        }
+
+        report.seconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+        return report;
+    }
+};
+
+#endif // SERVERLOADTEST_H
@@ -0,0 +1,230 @@
+#ifndef SPECTATORWALL_H
+#define SPECTATORWALL_H
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include "AssetCache.h"
+#include "Position.h"
+
+/**
+ * Many boards laid out in a grid and drawn with two batched draw calls.
+ *
+ * The cells of every board never change, so they are built once into a
+ * static vertex buffer. Tokens are textured quads into the shared token
+ * atlas, kept in a second buffer where each board owns a fixed range (a
+ * board always has 2 * (size - 2) tokens). Game threads hand in positions
+ * through publish(); the render thread rebuilds and uploads only the ranges
+ * of boards that changed since the last frame.
+ */
+class SpectatorWall
+{
+private:
+    static constexpr size_t VerticesPerQuad = 6; // Two triangles
+    static constexpr float Gap = 6.0f;           // Between boards
+
+    struct Board
+    {
+        sf::Vector2f origin;
+        Position pending; // Last published position, guarded by mutex
+        bool dirty;
+    };
+
+    size_t boardSize;
+    size_t tokensPerBoard;
+    float cellSize;
+    std::vector<Board> boards;
+
+    const sf::Texture &atlas;
+    sf::FloatRect atlasRects[2];
+
+    std::vector<sf::Vertex> cellVertices;
+    std::vector<sf::Vertex> tokenVertices;
+    sf::VertexBuffer cellBuffer{sf::PrimitiveType::Triangles, sf::VertexBuffer::Usage::Static};
+    sf::VertexBuffer tokenBuffer{sf::PrimitiveType::Triangles, sf::VertexBuffer::Usage::Dynamic};
+    bool useBuffers = false;
+
+    std::mutex mutex;
+    std::atomic<bool> anyDirty{false};
+
+    static void setQuad(sf::Vertex *quad, sf::Vector2f topLeft, sf::Vector2f size, sf::Color color,
+                        const sf::FloatRect &texture = {})
+    {
+        const sf::Vector2f corners[4] = {topLeft, {topLeft.x + size.x, topLeft.y},
+                                         {topLeft.x, topLeft.y + size.y}, topLeft + size};
+        const sf::Vector2f tex = texture.position;
+        const sf::Vector2f texSize = texture.size;
+        const sf::Vector2f texCorners[4] = {tex, {tex.x + texSize.x, tex.y},
+                                            {tex.x, tex.y + texSize.y}, tex + texSize};
+        static constexpr int order[VerticesPerQuad] = {0, 1, 2, 2, 1, 3};
+        for (size_t i = 0; i < VerticesPerQuad; ++i)
+            quad[i] = {corners[order[i]], color, texCorners[order[i]]};
+    }
+
+    // Same colours as GameBoard: scoring edges tinted, corners gray
+    sf::Color cellColor(size_t row, size_t col) const
+    {
+        const bool isEdgeRow = (row == 0 || row == boardSize - 1);
+        const bool isEdgeCol = (col == 0 || col == boardSize - 1);
+        if (isEdgeRow && isEdgeCol)
+            return {184, 176, 170};
+        if (isEdgeRow)
+            return {210, 241, 210};
+        if (isEdgeCol)
+            return {250, 210, 210};
+        return sf::Color::White;
+    }
+
+    void buildCells()
+    {
+        const size_t quadsPerBoard = 1 + boardSize * boardSize; // Black backing shows through as grid lines
+        cellVertices.resize(boards.size() * quadsPerBoard * VerticesPerQuad);
+        const float line = std::max(1.0f, cellSize * 0.08f);
+
+        sf::Vertex *quad = cellVertices.data();
+        for (const Board &board : boards)
+        {
+            setQuad(quad, board.origin, {cellSize * boardSize, cellSize * boardSize}, sf::Color::Black);
+            quad += VerticesPerQuad;
+            for (size_t row = 0; row < boardSize; ++row)
+            {
+                for (size_t col = 0; col < boardSize; ++col)
+                {
+                    const sf::Vector2f topLeft(board.origin.x + col * cellSize + line / 2,
+                                               board.origin.y + row * cellSize + line / 2);
+                    setQuad(quad, topLeft, {cellSize - line, cellSize - line}, cellColor(row, col));
+                    quad += VerticesPerQuad;
+                }
+            }
+        }
+    }
+
+    // Rewrite one board's token quads; finished games dim the loser (both on a stall)
+    void buildTokens(size_t slot, const Position &pos)
+    {
+        const Board &board = boards[slot];
+        const BoardGrid &grid = pos.getGrid();
+        const int winner = pos.isGameOver() ? pos.winner() : -2;
+        const float inset = cellSize * 0.1f;
+
+        sf::Vertex *quad = &tokenVertices[slot * tokensPerBoard * VerticesPerQuad];
+        for (int player = 0; player < 2; ++player)
+        {
+            const sf::Color color = winner == -2 || winner == player ? sf::Color::White
+                                                                     : sf::Color(110, 110, 110);
+            for (uint16_t idx : pos.getTokens(player))
+            {
+                const sf::Vector2f topLeft(board.origin.x + grid.column(idx) * cellSize + inset,
+                                           board.origin.y + grid.row(idx) * cellSize + inset);
+                setQuad(quad, topLeft, {cellSize - 2 * inset, cellSize - 2 * inset}, color, atlasRects[player]);
+                quad += VerticesPerQuad;
+            }
+        }
+    }
+
+    // Apply every position published since the last frame
+    void sync()
+    {
+        if (!anyDirty.exchange(false))
+            return;
+
+        const size_t boardVertices = tokensPerBoard * VerticesPerQuad;
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t slot = 0; slot < boards.size(); ++slot)
+        {
+            if (!boards[slot].dirty)
+                continue;
+            boards[slot].dirty = false;
+            buildTokens(slot, boards[slot].pending);
+            if (useBuffers && !tokenBuffer.update(&tokenVertices[slot * boardVertices], boardVertices,
+                                                  static_cast<unsigned>(slot * boardVertices)))
+            {
+                useBuffers = false; // Fall back to drawing from memory
+            }
+        }
+    }
+
+public:
+    /**
+     * Lay out boardCount boards of the given size in the area, as square
+     * as possible. Every board starts from the initial position.
+     */
+    SpectatorWall(size_t boardCount, size_t size, sf::Vector2f area, AssetCache &assets)
+        : boardSize(size),
+          tokensPerBoard(2 * (size - 2)),
+          atlas(assets.getTokenAtlas()),
+          atlasRects{assets.getTokenAtlasRect(0), assets.getTokenAtlasRect(1)}
+    {
+        if (boardCount == 0)
+            throw std::runtime_error("Spectator wall needs at least one board");
+        if (size < 3 || size - 2 > Position::MaxMoves)
+            throw std::runtime_error("Board size must be between 3 and 51");
+
+        const size_t columns = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(boardCount))));
+        const size_t rows = (boardCount + columns - 1) / columns;
+        const float boardPixels = std::min((area.x - Gap * (columns + 1)) / columns,
+                                           (area.y - Gap * (rows + 1)) / rows);
+        if (boardPixels < size)
+            throw std::runtime_error("Too many boards to fit in the window");
+        cellSize = std::floor(boardPixels / size);
+
+        const Position start(size);
+        boards.reserve(boardCount);
+        for (size_t slot = 0; slot < boardCount; ++slot)
+        {
+            const sf::Vector2f origin(Gap + (slot % columns) * (boardPixels + Gap),
+                                      Gap + (slot / columns) * (boardPixels + Gap));
+            boards.push_back({origin, start, true});
+        }
+        anyDirty = true;
+
+        buildCells();
+        tokenVertices.resize(boardCount * tokensPerBoard * VerticesPerQuad);
+
+        // Without buffer support the same vertices are drawn from memory
+        useBuffers = sf::VertexBuffer::isAvailable() &&
+                     cellBuffer.create(cellVertices.size()) && cellBuffer.update(cellVertices.data()) &&
+                     tokenBuffer.create(tokenVertices.size());
+    }
+
+    SpectatorWall(const SpectatorWall &) = delete;
+    SpectatorWall &operator=(const SpectatorWall &) = delete;
+
+    size_t getBoardCount() const { return boards.size(); }
+
+    // Show a new position on a board; safe to call from any thread
+    void publish(size_t slot, const Position &pos)
+    {
+        if (slot >= boards.size())
+            throw std::out_of_range("No such board on the wall");
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            boards[slot].pending = pos;
+            boards[slot].dirty = true;
+        }
+        anyDirty = true;
+    }
+
+    // Upload changed boards and draw the wall; render thread only
+    void draw(sf::RenderTarget &target)
+    {
+        sync();
+        const sf::RenderStates tokenStates(&atlas);
+        if (useBuffers)
+        {
+            target.draw(cellBuffer);
+            target.draw(tokenBuffer, tokenStates);
+        }
+        else
+        {
+            target.draw(cellVertices.data(), cellVertices.size(), sf::PrimitiveType::Triangles);
+            target.draw(tokenVertices.data(), tokenVertices.size(), sf::PrimitiveType::Triangles, tokenStates);
+        }
+    }
+};
+
+#endif // SPECTATORWALL_H
@@ -0,0 +1,490 @@
+#ifndef STATEENUMERATOR_H
+#define STATEENUMERATOR_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Position.h"
+
+/**
+ * Breadth-first enumerator of every position reachable from the start.
+ *
+ * Each move advances one token by one or two cells along its own lane, so
+ * the total advancement of all tokens identifies a level exactly: a
+ * position can only be reached from the two levels below it and never
+ * appears in two levels. Deduplicating within a level is therefore
+ * enough to count distinct positions.
+ *
+ * A level is collected in a sharded hash set. When that set grows past its
+ * memory share it is sorted and spilled to a run file, and the runs are
+ * merged into one deduplicated frontier file before the level is expanded.
+ * Expansion of a level is split across worker threads.
+ */
+class StateEnumerator
+{
+public:
+    static constexpr size_t MaxBoardSize = 16; // Lane coordinates fit in 4 bits
+
+    // Position packed as one 4-bit lane coordinate per token, plus the side to move in the top bit
+    struct Key
+    {
+        uint64_t lo;
+        uint64_t hi;
+
+        bool operator==(const Key &other) const { return lo == other.lo && hi == other.hi; }
+        bool operator<(const Key &other) const { return hi != other.hi ? hi < other.hi : lo < other.lo; }
+    };
+
+    struct Record
+    {
+        Key key;
+        uint16_t minPly; // Shortest path from the start
+        uint16_t maxPly; // Longest path from the start
+    };
+
+    struct Report
+    {
+        std::vector<uint64_t> positionsPerLevel;
+        std::vector<uint64_t> branching;    // Positions by number of legal moves
+        std::vector<uint64_t> shortestGame; // Terminal positions by shortest path length
+        std::vector<uint64_t> longestGame;  // Terminal positions by longest path length
+        uint64_t positions = 0;
+        uint64_t terminals = 0;
+        uint64_t spilledRuns = 0;
+        double seconds = 0;
+    };
+
+    using LevelCallback = std::function<void(size_t level, uint64_t positions)>;
+
+private:
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const { return mixHash(key.lo ^ mixHash(key.hi)); }
+    };
+
+    struct PlyRange
+    {
+        uint16_t minPly;
+        uint16_t maxPly;
+    };
+
+    // One level's positions, either still in memory or merged to a file
+    struct Frontier
+    {
+        std::vector<Record> memory;
+        std::string path;
+        uint64_t size = 0;
+    };
+
+    // Hands out batches of a frontier to worker threads
+    class FrontierReader
+    {
+    private:
+        const Frontier &frontier;
+        std::ifstream file;
+        uint64_t offset = 0;
+        std::mutex mutex;
+
+    public:
+        explicit FrontierReader(const Frontier &source) : frontier(source)
+        {
+            if (!frontier.path.empty())
+                file.open(frontier.path, std::ios::binary);
+        }
+
+        size_t next(std::vector<Record> &batch, size_t maxRecords)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            const size_t count = static_cast<size_t>(std::min<uint64_t>(maxRecords, frontier.size - offset));
+            batch.resize(count);
+            if (frontier.path.empty())
+            {
+                std::copy_n(frontier.memory.begin() + offset, count, batch.begin());
+            }
+            else
+            {
+                file.read(reinterpret_cast<char *>(batch.data()), count * sizeof(Record));
+            }
+            offset += count;
+            return count;
+        }
+    };
+
+    // Sequential reader over a sorted run file
+    class RunReader
+    {
+    private:
+        std::ifstream file;
+        std::vector<Record> buffer;
+        size_t position = 0;
+
+    public:
+        explicit RunReader(const std::string &path) : file(path, std::ios::binary) {}
+
+        bool next(Record &record)
+        {
+            if (position == buffer.size())
+            {
+                buffer.resize(4096);
+                file.read(reinterpret_cast<char *>(buffer.data()), buffer.size() * sizeof(Record));
+                buffer.resize(static_cast<size_t>(file.gcount()) / sizeof(Record));
+                position = 0;
+                if (buffer.empty())
+                    return false;
+            }
+            record = buffer[position++];
+            return true;
+        }
+    };
+
+    // Collects one level, spilling sorted runs to disk past its entry limit
+    class LevelBuilder
+    {
+    private:
+        struct Shard
+        {
+            std::mutex mutex;
+            std::unordered_map<Key, PlyRange, KeyHash> entries;
+        };
+
+        std::array<Shard, 64> shards;
+        std::atomic<size_t> count{0};
+        size_t entryLimit;
+        std::mutex spillMutex;
+        std::vector<std::string> runs;
+        std::string pathPrefix;
+
+        std::vector<Record> drain()
+        {
+            std::vector<Record> records;
+            records.reserve(count.load());
+            for (Shard &shard : shards)
+            {
+                for (const auto &[key, plies] : shard.entries)
+                    records.push_back({key, plies.minPly, plies.maxPly});
+                shard.entries.clear();
+            }
+            count = 0;
+            std::sort(records.begin(), records.end(),
+                      [](const Record &a, const Record &b) { return a.key < b.key; });
+            return records;
+        }
+
+        void writeRun(const std::vector<Record> &records)
+        {
+            const std::string path = pathPrefix + ".run" + std::to_string(runs.size());
+            std::ofstream out(path, std::ios::binary);
+            out.write(reinterpret_cast<const char *>(records.data()), records.size() * sizeof(Record));
+            if (!out)
+                throw std::runtime_error("Failed to write run " + path);
+            runs.push_back(path);
+        }
+
+        void spill()
+        {
+            std::lock_guard<std::mutex> spillLock(spillMutex);
+            if (count.load() <= entryLimit)
+                return;
+
+            std::vector<std::unique_lock<std::mutex>> locks;
+            for (Shard &shard : shards)
+                locks.emplace_back(shard.mutex);
+            writeRun(drain());
+        }
+
+    public:
+        LevelBuilder(size_t limit, std::string prefix)
+            : entryLimit(limit), pathPrefix(std::move(prefix)) {}
+
+        void insert(const Key &key, uint16_t minPly, uint16_t maxPly)
+        {
+            Shard &shard = shards[KeyHash()(key) % shards.size()];
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                auto [it, inserted] = shard.entries.try_emplace(key, PlyRange{minPly, maxPly});
+                if (inserted)
+                {
+                    ++count;
+                }
+                else
+                {
+                    it->second.minPly = std::min(it->second.minPly, minPly);
+                    it->second.maxPly = std::max(it->second.maxPly, maxPly);
+                }
+            }
+            if (count.load(std::memory_order_relaxed) > entryLimit)
+                spill();
+        }
+
+        size_t getRunCount() const { return runs.size(); }
+
+        // Called once all inserts are done; merges any runs into one sorted file
+        Frontier finalize()
+        {
+            Frontier frontier;
+            std::vector<Record> remaining = drain();
+            if (runs.empty())
+            {
+                frontier.size = remaining.size();
+                frontier.memory = std::move(remaining);
+                return frontier;
+            }
+
+            if (!remaining.empty())
+                writeRun(remaining);
+            remaining = std::vector<Record>();
+
+            frontier.path = pathPrefix + ".frontier";
+            frontier.size = mergeRuns(runs, frontier.path);
+            for (const std::string &run : runs)
+                std::remove(run.c_str());
+            return frontier;
+        }
+    };
+
+    size_t boardSize;
+    size_t lanes;
+    size_t entryLimit;
+    unsigned threadCount;
+    std::string tempDirectory;
+
+    // k-way merge of sorted runs, combining duplicate keys; returns the record count
+    static uint64_t mergeRuns(const std::vector<std::string> &runs, const std::string &outputPath)
+    {
+        using Head = std::pair<Record, size_t>;
+        auto greater = [](const Head &a, const Head &b) { return b.first.key < a.first.key; };
+        std::priority_queue<Head, std::vector<Head>, decltype(greater)> heads(greater);
+
+        std::vector<std::unique_ptr<RunReader>> readers;
+        for (size_t i = 0; i < runs.size(); ++i)
+        {
+            readers.push_back(std::make_unique<RunReader>(runs[i]));
+            Record record;
+            if (readers[i]->next(record))
+                heads.push({record, i});
+        }
+
+        std::ofstream out(outputPath, std::ios::binary);
+        std::vector<Record> buffer;
+        uint64_t written = 0;
+        auto flush = [&]()
+        {
+            out.write(reinterpret_cast<const char *>(buffer.data()), buffer.size() * sizeof(Record));
+            written += buffer.size();
+            buffer.clear();
+        };
+
+        while (!heads.empty())
+        {
+            auto [record, source] = heads.top();
+            heads.pop();
+
+            if (!buffer.empty() && buffer.back().key == record.key)
+            {
+                buffer.back().minPly = std::min(buffer.back().minPly, record.minPly);
+                buffer.back().maxPly = std::max(buffer.back().maxPly, record.maxPly);
+            }
+            else
+            {
+                // Keep the last record buffered so a duplicate can still merge into it
+                if (buffer.size() >= 4096)
+                {
+                    const Record last = buffer.back();
+                    buffer.pop_back();
+                    flush();
+                    buffer.push_back(last);
+                }
+                buffer.push_back(record);
+            }
+
+            Record next;
+            if (readers[source]->next(next))
+                heads.push({next, source});
+        }
+        flush();
+
+        if (!out)
+            throw std::runtime_error("Failed to write frontier " + outputPath);
+        return written;
+    }
+
+    Key encode(const Position &pos) const
+    {
+        Key key{0, 0};
+        const BoardGrid &grid = pos.getGrid();
+        for (int player = 0; player < 2; ++player)
+        {
+            for (uint16_t idx : pos.getTokens(player))
+            {
+                const size_t lane = (player == 0 ? grid.row(idx) : grid.column(idx)) - 1;
+                const uint64_t value = player == 0 ? grid.column(idx) : grid.row(idx);
+                const size_t bit = (player * lanes + lane) * 4;
+                if (bit < 64)
+                    key.lo |= value << bit;
+                else
+                    key.hi |= value << (bit - 64);
+            }
+        }
+        key.hi |= static_cast<uint64_t>(pos.getSideToMove()) << 63;
+        return key;
+    }
+
+    Position decode(const Key &key) const
+    {
+        BoardGrid grid(boardSize, boardSize);
+        for (size_t slot = 0; slot < 2 * lanes; ++slot)
+        {
+            const size_t bit = slot * 4;
+            const size_t value = (bit < 64 ? key.lo >> bit : key.hi >> (bit - 64)) & 0xf;
+            const size_t lane = slot % lanes + 1;
+            if (slot < lanes)
+                grid.set(grid.index(value, lane), BoardGrid::Player0);
+            else
+                grid.set(grid.index(lane, value), BoardGrid::Player1);
+        }
+        return Position(grid, static_cast<int>(key.hi >> 63));
+    }
+
+    // Expand every position of a frontier into the builders one and two levels up
+    void expandLevel(const Frontier &frontier, LevelBuilder &nextLevel, LevelBuilder &skipLevel, Report &report)
+    {
+        FrontierReader reader(frontier);
+        std::mutex reportMutex;
+
+        auto worker = [&]()
+        {
+            Report local;
+            local.branching.assign(Position::MaxMoves + 1, 0);
+            std::vector<Record> batch;
+            Move moves[Position::MaxMoves];
+
+            while (reader.next(batch, 1 << 14) > 0)
+            {
+                for (const Record &record : batch)
+                {
+                    Position pos = decode(record.key);
+                    const int count = pos.isGameOver() ? 0 : pos.generateMoves(moves);
+                    ++local.branching[count];
+
+                    if (count == 0)
+                    {
+                        ++local.terminals;
+                        if (local.shortestGame.size() <= record.maxPly)
+                        {
+                            local.shortestGame.resize(record.maxPly + 1, 0);
+                            local.longestGame.resize(record.maxPly + 1, 0);
+                        }
+                        ++local.shortestGame[record.minPly];
+                        ++local.longestGame[record.maxPly];
+                        continue;
+                    }
+
+                    const size_t step = pos.getGrid().forwardOffset(pos.getSideToMove());
+                    for (int i = 0; i < count; ++i)
+                    {
+                        LevelBuilder &target = static_cast<size_t>(moves[i].to - moves[i].from) == step ? nextLevel : skipLevel;
+                        const Position::Undo undo = pos.makeMove(moves[i]);
+                        target.insert(encode(pos), record.minPly + 1, record.maxPly + 1);
+                        pos.unmakeMove(undo);
+                    }
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(reportMutex);
+            mergeReport(report, local);
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned i = 0; i < threadCount; ++i)
+            workers.emplace_back(worker);
+        for (std::thread &thread : workers)
+            thread.join();
+    }
+
+    static void addHistogram(std::vector<uint64_t> &into, const std::vector<uint64_t> &from)
+    {
+        if (into.size() < from.size())
+            into.resize(from.size(), 0);
+        for (size_t i = 0; i < from.size(); ++i)
+            into[i] += from[i];
+    }
+
+    static void mergeReport(Report &into, const Report &from)
+    {
+        addHistogram(into.branching, from.branching);
+        addHistogram(into.shortestGame, from.shortestGame);
+        addHistogram(into.longestGame, from.longestGame);
+        into.terminals += from.terminals;
+    }
+
+    std::unique_ptr<LevelBuilder> makeBuilder(size_t level) const
+    {
+        return std::make_unique<LevelBuilder>(
+            entryLimit, tempDirectory + "/level" + std::to_string(level));
+    }
+
+public:
+    /**
+     * memoryMegabytes bounds the in-memory hash sets; two levels are being
+     * collected at any time, so each gets half of it.
+     */
+    StateEnumerator(size_t size, size_t memoryMegabytes, unsigned threads, std::string tempDir)
+        : boardSize(size), lanes(size - 2),
+          entryLimit(std::max<size_t>(memoryMegabytes * 1024 * 1024 / 2 / 64, 1024)),
+          threadCount(std::max(threads, 1u)), tempDirectory(std::move(tempDir))
+    {
+        if (size < 3 || size > MaxBoardSize)
+            throw std::out_of_range("Enumerator supports boards from 3 to 16");
+    }
+
+    Report run(const LevelCallback &onLevel = {})
+    {
+        const auto startTime = std::chrono::steady_clock::now();
+        Report report;
+
+        // Builders for the next two levels; every move advances by one or two cells
+        std::unique_ptr<LevelBuilder> current = makeBuilder(0);
+        std::unique_ptr<LevelBuilder> next = makeBuilder(1);
+        std::unique_ptr<LevelBuilder> skip = makeBuilder(2);
+        current->insert(encode(Position(boardSize)), 0, 0);
+
+        const size_t maxLevel = 2 * lanes * (boardSize - 1);
+        for (size_t level = 0; level <= maxLevel; ++level)
+        {
+            report.spilledRuns += current->getRunCount();
+            Frontier frontier = current->finalize();
+            current.reset();
+
+            report.positionsPerLevel.push_back(frontier.size);
+            report.positions += frontier.size;
+            if (onLevel)
+                onLevel(level, frontier.size);
+
+            expandLevel(frontier, *next, *skip, report);
+            if (!frontier.path.empty())
+                std::remove(frontier.path.c_str());
+
+            current = std::move(next);
+            next = std::move(skip);
+            skip = makeBuilder(level + 3);
+        }
+
+        report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        return report;
+    }
+};
+
+#endif // STATEENUMERATOR_H
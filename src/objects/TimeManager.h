@@ -0,0 +1,126 @@
+#ifndef TIMEMANAGER_H
+#define TIMEMANAGER_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include "Position.h"
+
+/**
+ * Splits a player's remaining clock time into a budget for one move.
+ *
+ * The game phase is estimated from how far the player's tokens still have
+ * to travel: a token advances one or two cells per move, so the remaining
+ * distance bounds how many moves the player has left. The soft limit is the
+ * time the search aims for and the hard limit is the deadline it must
+ * never pass, which always leaves Overhead milliseconds on the clock.
+ */
+class TimeManager
+{
+public:
+    static constexpr int64_t OverheadMs = 5; // Reserved for move application and thread handoff
+
+    struct Budget
+    {
+        int64_t softMs;
+        int64_t hardMs;
+    };
+
+    static int estimateMovesLeft(const Position &pos)
+    {
+        const BoardGrid &grid = pos.getGrid();
+        const int player = pos.getSideToMove();
+        const int last = static_cast<int>(grid.getWidth()) - 1;
+        int distance = 0;
+        for (uint16_t idx : pos.getTokens(player))
+            distance += last - (player == 0 ? grid.column(idx) : grid.row(idx));
+
+        // Jumps cover two cells, so assume a bit better than one cell per move
+        return std::max(2, distance * 2 / 3);
+    }
+
+    static Budget plan(const Position &pos, int64_t remainingMs, int64_t incrementMs)
+    {
+        const int64_t usable = remainingMs - OverheadMs;
+        if (usable <= 1)
+            return {1, 1};
+
+        const int64_t share = usable / estimateMovesLeft(pos) + incrementMs * 3 / 4;
+        const int64_t soft = std::clamp<int64_t>(share, 1, usable / 2);
+        const int64_t hard = std::clamp<int64_t>(soft * 4, soft, usable / 2);
+        return {soft, hard};
+    }
+};
+
+/**
+ * Per-player statistics of how long moves took against their deadlines:
+ * a count of missed deadlines and a histogram of move times in
+ * power-of-two millisecond buckets.
+ */
+class MoveTimeLog
+{
+public:
+    static constexpr int Buckets = 20; // Up to about 8.7 minutes
+
+private:
+    struct Stats
+    {
+        uint64_t moves = 0;
+        uint64_t misses = 0;
+        int64_t totalMs = 0;
+        int64_t maxMs = 0;
+        int64_t worstOverrunMs = 0;
+        std::array<uint64_t, Buckets> histogram{};
+    };
+
+    Stats stats[2];
+
+public:
+    // Returns true if the move missed its deadline
+    bool record(int player, int64_t usedMs, int64_t deadlineMs)
+    {
+        Stats &entry = stats[player];
+        ++entry.moves;
+        entry.totalMs += usedMs;
+        entry.maxMs = std::max(entry.maxMs, usedMs);
+
+        int bucket = 0;
+        while (bucket + 1 < Buckets && (int64_t(1) << bucket) <= usedMs)
+            ++bucket;
+        ++entry.histogram[bucket];
+
+        if (usedMs <= deadlineMs)
+            return false;
+        ++entry.misses;
+        entry.worstOverrunMs = std::max(entry.worstOverrunMs, usedMs - deadlineMs);
+        return true;
+    }
+
+    void print(std::ostream &out) const
+    {
+        for (int player = 0; player < 2; ++player)
+        {
+            const Stats &entry = stats[player];
+            if (entry.moves == 0)
+                continue;
+
+            out << "Player " << player + 1 << ": " << entry.moves << " timed moves, mean "
+                << entry.totalMs / static_cast<int64_t>(entry.moves) << " ms, max " << entry.maxMs
+                << " ms, " << entry.misses << " deadline misses";
+            if (entry.misses)
+                out << " (worst by " << entry.worstOverrunMs << " ms)";
+            out << "\n";
+
+            for (int bucket = 0; bucket < Buckets; ++bucket)
+            {
+                if (entry.histogram[bucket] == 0)
+                    continue;
+                const int64_t low = bucket == 0 ? 0 : int64_t(1) << (bucket - 1);
+                out << "  " << low << "-" << (int64_t(1) << bucket) << " ms: " << entry.histogram[bucket] << "\n";
+            }
+        }
+    }
+};
+
+#endif // TIMEMANAGER_H
@@ -11,26 +11,21 @@ private:
     std::pair<int, int> position; // Position on the board
     int player;                   // Player who owns the token
     bool canMove;                 // Whether the token can move
-    sf::Texture texture;          // Texture for the token's image
+    const sf::Texture &texture;   // Shared texture for the token's image
     sf::Sprite sprite;            // Sprite for the token
     float scaleFactor;            // Scale factor for the token
     bool reachedEnd = false;
 
 public:
     // Constructor with coordinates
-    Token(int x, int y, int player, const std::string &imagePath, float cellW, float cellH)
+    Token(int x, int y, int player, const sf::Texture &texture, float cellW, float cellH)
         : position(make_pair(x, y)),
           player(player),
           canMove(true),
-          texture(),
+          texture(texture),
           sprite(texture) // Initialize sprite with the texture
     {
-        if (!texture.loadFromFile(imagePath))
-        {
-            std::cerr << "Failed to load texture: " << imagePath << std::endl;
-        }
-        sprite.setTexture(texture, true); // Update sprite with the loaded texture
-                                          // Get original texture size
+        // Get original texture size
         sf::Vector2u texSize = texture.getSize();
 
         scaleFactor = std::min(
@@ -0,0 +1,221 @@
+#ifndef TRACESUMMARY_H
+#define TRACESUMMARY_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "BoardGrid.h"
+#include "SearchTrace.h"
+
+/**
+ * Aggregates a SearchTrace file: node counts by reason and ply, cutoff
+ * rates, per-run totals and the subtrees near the root that took the
+ * most nodes.
+ *
+ * Records arrive in post order, so a node's move path is only known once
+ * its ancestors return. Candidate subtrees wait in per-ply lists that the
+ * parent adopts, each trimmed to the number of subtrees wanted.
+ */
+class TraceSummary
+{
+public:
+    static constexpr int HotPlies = 3; // Subtrees are ranked at plies 1 to HotPlies
+
+    struct PlyStats
+    {
+        uint64_t nodes = 0;
+        uint64_t expanded = 0; // Nodes that searched children
+        uint64_t legalMoves = 0;
+        uint64_t searchedMoves = 0;
+        uint64_t betaCuts = 0;
+        uint64_t firstMoveCuts = 0; // Beta cuts on the first child
+        uint64_t tableCuts = 0;     // Transposition table or persistent cache
+    };
+
+    struct Run
+    {
+        uint32_t writer = 0;
+        uint16_t run = 0;
+        int boardSize = 0;
+        int depthLimit = 0;
+        int depth = 0; // Deepest completed iteration
+        int score = 0;
+        uint64_t nodes = 0;
+        uint32_t micros = 0;
+        std::vector<uint64_t> iterationNodes;
+    };
+
+    struct Subtree
+    {
+        uint64_t nodes = 0;
+        size_t run = 0; // Index into getRuns()
+        int ply = 0;
+        int depth = 0; // Remaining depth at the subtree root
+        int score = 0;
+        int reason = 0;
+        std::vector<std::pair<uint16_t, uint16_t>> path; // Moves from the root, as grid indices
+    };
+
+private:
+    struct WriterState
+    {
+        size_t run = SIZE_MAX;
+        std::array<std::vector<Subtree>, HotPlies + 2> pending; // Unparented candidates by the ply they wait for
+    };
+
+    size_t topCount;
+    uint64_t records = 0;
+    std::array<uint64_t, SearchTrace::ReasonCount> reasons{};
+    std::vector<PlyStats> plies;
+    std::vector<Run> runs;
+    std::map<uint32_t, WriterState> writers;
+    std::vector<Subtree> hot;
+
+    static bool larger(const Subtree &a, const Subtree &b) { return a.nodes > b.nodes; }
+
+    void keepLargest(std::vector<Subtree> &list) const
+    {
+        if (list.size() <= topCount)
+            return;
+        std::nth_element(list.begin(), list.begin() + topCount, list.end(), larger);
+        list.resize(topCount);
+    }
+
+    // Root children finished; the stranded candidates have their full path
+    void settle(WriterState &state)
+    {
+        for (Subtree &subtree : state.pending[1])
+            hot.push_back(std::move(subtree));
+        state.pending[1].clear();
+        for (size_t ply = 2; ply < state.pending.size(); ++ply)
+            state.pending[ply].clear(); // Only left over by an aborted search
+        keepLargest(hot);
+    }
+
+    void addRecord(uint32_t writer, const SearchTrace::Record &record)
+    {
+        ++records;
+        if (record.reason < SearchTrace::ReasonCount)
+            ++reasons[record.reason];
+        WriterState &state = writers[writer];
+
+        if (record.reason == SearchTrace::RunStart)
+        {
+            settle(state);
+            state.run = runs.size();
+            Run run;
+            run.writer = writer;
+            run.run = record.run;
+            run.boardSize = record.boardSize;
+            run.depthLimit = record.depth;
+            runs.push_back(run);
+            return;
+        }
+        if (state.run == SIZE_MAX)
+            return; // Tail of a run that began before the trace did
+        Run &run = runs[state.run];
+        run.micros = std::max(run.micros, record.micros);
+
+        if (record.reason == SearchTrace::Iteration)
+        {
+            settle(state);
+            run.depth = record.depth;
+            run.score = record.score;
+            run.iterationNodes.push_back(record.subtreeNodes);
+            return;
+        }
+
+        ++run.nodes;
+        if (plies.size() <= record.ply)
+            plies.resize(record.ply + 1u);
+        PlyStats &ply = plies[record.ply];
+        ++ply.nodes;
+        if (record.searched > 0)
+        {
+            ++ply.expanded;
+            ply.legalMoves += record.moves;
+            ply.searchedMoves += record.searched;
+        }
+        if (record.reason == SearchTrace::BetaCut)
+        {
+            ++ply.betaCuts;
+            if (record.searched == 1)
+                ++ply.firstMoveCuts;
+        }
+        if (record.reason == SearchTrace::TableCut || record.reason == SearchTrace::PersistentCut)
+            ++ply.tableCuts;
+
+        if (record.ply == 0 || record.ply > HotPlies)
+            return;
+
+        // Adopt the children waiting for this node, then wait for the parent
+        std::vector<Subtree> &children = state.pending[record.ply + 1];
+        std::vector<Subtree> &siblings = state.pending[record.ply];
+        for (Subtree &child : children)
+        {
+            child.path.emplace_back(record.from, record.to);
+            siblings.push_back(std::move(child));
+        }
+        children.clear();
+
+        Subtree subtree;
+        subtree.nodes = record.subtreeNodes;
+        subtree.run = state.run;
+        subtree.ply = record.ply;
+        subtree.depth = record.depth;
+        subtree.score = record.score;
+        subtree.reason = record.reason;
+        subtree.path.emplace_back(record.from, record.to);
+        siblings.push_back(std::move(subtree));
+        keepLargest(siblings);
+    }
+
+public:
+    explicit TraceSummary(size_t hotSubtrees) : topCount(hotSubtrees) {}
+
+    void read(const std::string &path)
+    {
+        SearchTrace::read(path, [this](uint32_t writer, const SearchTrace::Record &record)
+                          { addRecord(writer, record); });
+        for (auto &writer : writers)
+            settle(writer.second);
+        for (Subtree &subtree : hot)
+            std::reverse(subtree.path.begin(), subtree.path.end());
+        std::sort(hot.begin(), hot.end(), larger);
+    }
+
+    uint64_t getRecords() const { return records; }
+    uint64_t getReasonCount(int reason) const { return reasons[reason]; }
+    const std::vector<PlyStats> &getPlies() const { return plies; }
+    const std::vector<Run> &getRuns() const { return runs; }
+    const std::vector<Subtree> &getHotSubtrees() const { return hot; }
+
+    static const char *reasonName(int reason)
+    {
+        static const char *const names[SearchTrace::ReasonCount] = {
+            "run start", "iteration", "terminal", "leaf", "table cut",
+            "persistent cut", "beta cut", "all node", "exact node", "stopped"};
+        return reason >= 0 && reason < SearchTrace::ReasonCount ? names[reason] : "unknown";
+    }
+
+    // "fromX,fromY-toX,toY" moves separated by spaces
+    static std::string pathToString(const Subtree &subtree, int boardSize)
+    {
+        const BoardGrid grid(boardSize, boardSize);
+        std::string text;
+        for (const auto &move : subtree.path)
+        {
+            if (!text.empty())
+                text += ' ';
+            text += std::to_string(grid.column(move.first)) + "," + std::to_string(grid.row(move.first)) + "-" +
+                    std::to_string(grid.column(move.second)) + "," + std::to_string(grid.row(move.second));
+        }
+        return text;
+    }
+};
+
+#endif // TRACESUMMARY_H
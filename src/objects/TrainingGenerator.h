@@ -0,0 +1,404 @@
+#ifndef TRAININGGENERATOR_H
+#define TRAININGGENERATOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Position.h"
+#include "Search.h"
+
+/**
+ * Self-play generator of training samples for a learned evaluator.
+ *
+ * Games start from the standard start position and are played on every
+ * core. A move is either random or chosen by a shallow Search, and each
+ * sample records the position, the side to move, the final outcome from
+ * that side's point of view and the move the search preferred.
+ *
+ * Samples go into fixed-size shards named shard-NNNNN.bin. A shard is
+ * written to a .tmp file and renamed once its header, record count and
+ * checksum are final, so a finished shard is never partial. Every shard
+ * is generated from its own seed and a cleared search table, which makes
+ * its contents depend only on the options and its index: an interrupted
+ * run resumes by skipping the shards that exist and redoing the rest.
+ *
+ * Shard layout: a 64-byte Header, then recordCount records of recordSize
+ * bytes each:
+ *   side, outcome (int8: 1 win, -1 loss, 0 stall), flags, reserved,
+ *   ply (uint16), best move fromX, fromY, toX, toY,
+ *   then one coordinate per token along its own lane, player 0's tokens
+ *   first, both players' tokens ordered by lane.
+ */
+class TrainingGenerator
+{
+public:
+    static constexpr uint32_t Version = 1;
+    static constexpr uint8_t SearchedMove = 1; // Record flag: best move came from a search
+
+    struct Options
+    {
+        size_t boardSize = 8;
+        uint64_t samples = 1000000;
+        uint64_t samplesPerShard = 1 << 16;
+        unsigned threads = 1;
+        int searchDepth = 4;       // 0 plays and records random moves only
+        uint64_t searchNodes = 20000;
+        double randomMoveRate = 0.1; // Chance of a random move after the opening
+        int randomOpeningPlies = 4;
+        uint64_t seed = 1;
+        std::string directory = ".";
+    };
+
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t boardSize;
+        uint32_t recordSize;
+        uint64_t recordCount;
+        uint64_t checksum; // FNV-1a over all records
+        uint64_t seed;
+        uint64_t shardIndex;
+        uint64_t searchDepth; // Options::searchDepth; the records depend on it
+        uint64_t reserved;
+    };
+
+    struct Progress
+    {
+        uint64_t samples;
+        uint64_t bytes;
+        size_t shardsDone;
+        size_t shardsTotal;
+        double seconds;
+    };
+
+    struct Report
+    {
+        uint64_t samples = 0; // In shards finished by this run
+        uint64_t bytes = 0;   // Written by this run, including discarded shards
+        size_t shardsWritten = 0;
+        size_t shardsSkipped = 0; // Already complete from an earlier run
+        double seconds = 0;
+        bool interrupted = false;
+    };
+
+    using ProgressCallback = std::function<void(const Progress &)>;
+
+    static_assert(sizeof(Header) == 64, "Shard header must stay 64 bytes");
+
+    static size_t recordSize(size_t boardSize)
+    {
+        return 10 + 2 * (boardSize - 2);
+    }
+
+    static uint64_t checksum(const uint8_t *data, size_t length, uint64_t hash = 0xcbf29ce484222325ULL)
+    {
+        return fnv1a(data, length, hash);
+    }
+
+    static std::string shardPath(const std::string &directory, size_t index)
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "shard-%05zu.bin", index);
+        return (std::filesystem::path(directory) / name).string();
+    }
+
+    // Whether a shard file is complete and its records match the checksum
+    static bool verifyShard(const std::string &path, Header &header)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+            std::memcmp(header.magic, "GTTD", 4) != 0 || header.version != Version)
+            return false;
+
+        std::vector<uint8_t> buffer(1 << 20);
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        uint64_t remaining = header.recordCount * header.recordSize;
+        while (remaining > 0)
+        {
+            const size_t chunk = static_cast<size_t>(std::min<uint64_t>(remaining, buffer.size()));
+            if (!in.read(reinterpret_cast<char *>(buffer.data()), chunk))
+                return false;
+            hash = checksum(buffer.data(), chunk, hash);
+            remaining -= chunk;
+        }
+        return hash == header.checksum && in.peek() == EOF;
+    }
+
+private:
+    struct Sample
+    {
+        std::vector<uint8_t> lanes;
+        uint16_t ply;
+        uint8_t side;
+        uint8_t flags;
+        uint8_t best[4]; // fromX, fromY, toX, toY
+    };
+
+    Options options;
+    std::atomic<size_t> nextShard{0};
+    std::atomic<uint64_t> samplesWritten{0}; // Includes shards still being written
+    std::atomic<uint64_t> bytesWritten{0};
+    std::atomic<uint64_t> completedSamples{0};
+    std::atomic<size_t> shardsDone{0};
+    std::atomic<bool> stopRequested{false};
+    std::vector<size_t> pendingShards;
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    size_t shardCount() const
+    {
+        return static_cast<size_t>((options.samples + options.samplesPerShard - 1) / options.samplesPerShard);
+    }
+
+    uint64_t shardSamples(size_t index) const
+    {
+        const uint64_t start = index * options.samplesPerShard;
+        return std::min(options.samplesPerShard, options.samples - start);
+    }
+
+    static void lanesOf(const Position &pos, std::vector<uint8_t> &lanes)
+    {
+        const BoardGrid &grid = pos.getGrid();
+        lanes.clear();
+        for (int player = 0; player < 2; ++player)
+        {
+            // Token slots keep their lane for the whole game
+            for (uint16_t idx : pos.getTokens(player))
+                lanes.push_back(static_cast<uint8_t>(player == 0 ? grid.column(idx) : grid.row(idx)));
+        }
+    }
+
+    // Play one game, appending its samples labelled with the final outcome
+    void playGame(Search &search, std::mt19937_64 &rng, std::vector<Sample> &samples, std::vector<int8_t> &outcomes)
+    {
+        Position pos(options.boardSize);
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        const size_t first = samples.size();
+
+        Move moves[Position::MaxMoves];
+        for (uint16_t ply = 0; !pos.isGameOver(); ++ply)
+        {
+            const int count = pos.generateMoves(moves);
+            Sample sample;
+            lanesOf(pos, sample.lanes);
+            sample.ply = ply;
+            sample.side = static_cast<uint8_t>(pos.getSideToMove());
+            sample.flags = 0;
+
+            Move best = moves[rng() % count];
+            if (options.searchDepth > 0)
+            {
+                Search::Limits limits;
+                limits.depth = options.searchDepth;
+                limits.nodes = options.searchNodes;
+                limits.stop = &stopRequested;
+                const Search::Info info = search.run(pos, limits);
+                if (info.depth > 0)
+                {
+                    best = info.bestMove;
+                    sample.flags |= SearchedMove;
+                }
+            }
+            const BoardGrid &grid = pos.getGrid();
+            sample.best[0] = static_cast<uint8_t>(grid.column(best.from));
+            sample.best[1] = static_cast<uint8_t>(grid.row(best.from));
+            sample.best[2] = static_cast<uint8_t>(grid.column(best.to));
+            sample.best[3] = static_cast<uint8_t>(grid.row(best.to));
+
+            const bool random = ply < options.randomOpeningPlies || unit(rng) < options.randomMoveRate;
+            const Move played = random ? moves[rng() % count] : best;
+            samples.push_back(std::move(sample));
+            pos.makeMove(played);
+        }
+
+        const int winner = pos.winner();
+        for (size_t i = first; i < samples.size(); ++i)
+            outcomes.push_back(winner < 0 ? 0 : (winner == samples[i].side ? 1 : -1));
+    }
+
+    static void encode(const Sample &sample, int8_t outcome, uint8_t *out)
+    {
+        out[0] = sample.side;
+        out[1] = static_cast<uint8_t>(outcome);
+        out[2] = sample.flags;
+        out[3] = 0;
+        std::memcpy(out + 4, &sample.ply, sizeof(sample.ply));
+        std::memcpy(out + 6, sample.best, sizeof(sample.best));
+        std::memcpy(out + 10, sample.lanes.data(), sample.lanes.size());
+    }
+
+    // Returns false if the run was stopped before the shard was finished
+    bool writeShard(size_t index, Search &search)
+    {
+        const std::string path = shardPath(options.directory, index);
+        const std::string tempPath = path + ".tmp";
+        const size_t size = recordSize(options.boardSize);
+        const uint64_t wanted = shardSamples(index);
+
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out)
+            throw std::runtime_error("Cannot write " + tempPath);
+
+        Header header{};
+        std::memcpy(header.magic, "GTTD", 4);
+        header.version = Version;
+        header.boardSize = static_cast<uint32_t>(options.boardSize);
+        header.recordSize = static_cast<uint32_t>(size);
+        header.seed = options.seed;
+        header.shardIndex = index;
+        header.searchDepth = static_cast<uint64_t>(options.searchDepth);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        std::mt19937_64 rng(mixHash(options.seed ^ mixHash(index + 1)));
+        search.clear();
+
+        std::vector<Sample> samples;
+        std::vector<int8_t> outcomes;
+        std::vector<uint8_t> buffer;
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        uint64_t written = 0;
+        while (written < wanted)
+        {
+            if (stopRequested)
+            {
+                out.close();
+                std::remove(tempPath.c_str());
+                return false;
+            }
+
+            samples.clear();
+            outcomes.clear();
+            playGame(search, rng, samples, outcomes);
+
+            // The last game of a shard is cut to fit
+            const size_t take = static_cast<size_t>(std::min<uint64_t>(samples.size(), wanted - written));
+            buffer.resize(take * size);
+            for (size_t i = 0; i < take; ++i)
+                encode(samples[i], outcomes[i], buffer.data() + i * size);
+
+            out.write(reinterpret_cast<const char *>(buffer.data()), buffer.size());
+            hash = checksum(buffer.data(), buffer.size(), hash);
+            written += take;
+            samplesWritten += take;
+            bytesWritten += buffer.size();
+        }
+
+        header.recordCount = written;
+        header.checksum = hash;
+        out.seekp(0);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.close();
+        if (!out)
+            throw std::runtime_error("Failed writing " + tempPath);
+
+        std::filesystem::rename(tempPath, path);
+        completedSamples += written;
+        return true;
+    }
+
+    void workerLoop()
+    {
+        try
+        {
+            Search search(16);
+            while (!stopRequested)
+            {
+                const size_t slot = nextShard.fetch_add(1);
+                if (slot >= pendingShards.size())
+                    return;
+                if (writeShard(pendingShards[slot], search))
+                    ++shardsDone;
+            }
+        }
+        catch (...)
+        {
+            // Stop the other workers and rethrow from run()
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error)
+                error = std::current_exception();
+            stopRequested = true;
+        }
+    }
+
+public:
+    explicit TrainingGenerator(const Options &generatorOptions) : options(generatorOptions)
+    {
+        if (options.boardSize < 3 || options.boardSize - 2 > Position::MaxMoves)
+            throw std::runtime_error("Board size must be between 3 and 51");
+        if (options.samplesPerShard == 0)
+            throw std::runtime_error("Shards must hold at least one sample");
+        options.threads = std::max(options.threads, 1u);
+    }
+
+    // May be called from another thread or a signal handler; unfinished shards are discarded
+    void stop() { stopRequested = true; }
+
+    Report run(const ProgressCallback &onProgress = {})
+    {
+        const auto startTime = std::chrono::steady_clock::now();
+        std::filesystem::create_directories(options.directory);
+
+        // Resume: keep complete shards with matching settings, redo everything else
+        Report report;
+        pendingShards.clear();
+        for (size_t index = 0; index < shardCount(); ++index)
+        {
+            const std::string path = shardPath(options.directory, index);
+            std::remove((path + ".tmp").c_str());
+
+            Header header{};
+            std::ifstream in(path, std::ios::binary);
+            const bool complete = in.read(reinterpret_cast<char *>(&header), sizeof(header)) &&
+                                  std::memcmp(header.magic, "GTTD", 4) == 0 && header.version == Version &&
+                                  header.boardSize == options.boardSize && header.seed == options.seed &&
+                                  header.searchDepth == static_cast<uint64_t>(options.searchDepth) &&
+                                  header.recordCount == shardSamples(index) &&
+                                  std::filesystem::file_size(path) ==
+                                      sizeof(Header) + header.recordCount * header.recordSize;
+            if (complete)
+                ++report.shardsSkipped;
+            else
+                pendingShards.push_back(index);
+        }
+
+        std::vector<std::thread> workers;
+        const unsigned threadCount = static_cast<unsigned>(std::min<size_t>(options.threads, pendingShards.size()));
+        for (unsigned i = 0; i < threadCount; ++i)
+            workers.emplace_back(&TrainingGenerator::workerLoop, this);
+
+        // Report progress from this thread while the workers run
+        while (onProgress && shardsDone < pendingShards.size() && !stopRequested)
+        {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            onProgress({samplesWritten, bytesWritten, report.shardsSkipped + shardsDone, shardCount(),
+                        std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count()});
+        }
+        for (std::thread &worker : workers)
+            worker.join();
+        if (error)
+            std::rethrow_exception(error);
+
+        report.samples = completedSamples;
+        report.bytes = bytesWritten;
+        report.shardsWritten = shardsDone;
+        report.interrupted = shardsDone < pendingShards.size();
+        report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        return report;
+    }
+};
+
+#endif // TRAININGGENERATOR_H
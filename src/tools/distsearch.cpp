@@ -0,0 +1,56 @@
+#include "objects/DistributedSolver.h"
+#include <iostream>
+#include <string>
+
+// Usage: distsearch coordinator <board size> <port> [units] [bind address]
+//        distsearch worker <host> <port> [table MB]
+int main(int argc, char **argv)
+{
+    const std::string mode = argc > 1 ? argv[1] : "";
+    if (argc < 4 || (mode != "coordinator" && mode != "worker"))
+    {
+        std::cerr << "Usage: " << argv[0] << " coordinator <board size> <port> [units] [bind address]\n"
+                  << "       " << argv[0] << " worker <host> <port> [table MB]\n";
+        return 1;
+    }
+
+    try
+    {
+        const uint16_t port = static_cast<uint16_t>(std::stoul(argv[3]));
+        if (mode == "coordinator")
+        {
+            const size_t size = std::stoul(argv[2]);
+            const size_t units = argc > 4 ? std::stoul(argv[4]) : 256;
+            const std::string address = argc > 5 ? argv[5] : "127.0.0.1";
+            if (size < 3 || size > 51)
+            {
+                std::cerr << "Board size must be between 3 and 51\n";
+                return 1;
+            }
+
+            SearchCoordinator coordinator(size, units);
+            const SearchCoordinator::Report report = coordinator.run(port, address);
+            std::cout << "Player 1 (first to move) "
+                      << (report.result == ProofSolver::Result::Win     ? "wins"
+                          : report.result == ProofSolver::Result::NoWin ? "cannot force a win"
+                                                                        : "is unresolved")
+                      << " on " << size << "x" << size << "\n"
+                      << "Units: " << report.units << ", reissued: " << report.reissued << "\n"
+                      << "Worker nodes: " << report.workerNodes << " in " << report.seconds << "s ("
+                      << static_cast<uint64_t>(report.workerNodes / std::max(report.seconds, 1e-3)) << " nps)\n";
+        }
+        else
+        {
+            const size_t tableMegabytes = argc > 4 ? std::stoul(argv[4]) : 256;
+            SearchWorker worker(tableMegabytes);
+            const size_t solved = worker.run(argv[2], port);
+            std::cout << "Solved " << solved << " units\n";
+        }
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,452 @@
+#include "objects/GameSnapshot.h"
+#include "objects/MemoryBudget.h"
+#include "objects/Search.h"
+#include "objects/TimeManager.h"
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+/**
+ * Line-based engine protocol on stdin/stdout:
+ *
+ *   newgame <size>               start a new game on a size x size board
+ *   position [moves...]          start position of the current size plus moves
+ *   position snapshot <path> [moves...]  saved game or tool snapshot plus moves
+ *   savesnapshot <path>          write the current position as a snapshot
+ *   go [depth N] [nodes N] [movetime MS] [wtime MS btime MS [winc MS] [binc MS]] [infinite]
+ *   stop                         end the running search and report bestmove
+ *   perft <depth>                count leaf positions per root move
+ *   setoption name Hash value <MB>
+ *   setoption name PersistentCache value <path>
+ *   setoption name Trace value <path>   record every searched node; no value stops tracing
+ *   setoption name Memory value <MB>    limit for the table, cache and trace together; 0 for none
+ *   memstats                     memory used per subsystem
+ *   timestats                    move time histogram and deadline misses so far
+ *   print | isready | quit
+ *
+ * Moves are written "fromX,fromY-toX,toY". While a search runs, isready is
+ * answered at once and commands that would change the position, options or
+ * move-time log are refused until stop or bestmove.
+ */
+class Engine
+{
+private:
+    // Split of the Memory option
+    static constexpr double TableShare = 0.7;
+    static constexpr double CacheShare = 0.25;
+    static constexpr double TraceShare = 0.05;
+    static constexpr size_t CacheMegabytes = 256; // Size of a new persistent cache without a limit
+    static constexpr size_t TraceBytes = SearchTrace::BlocksPerWriter * sizeof(SearchTrace::Record) * SearchTrace::BlockRecords;
+
+    size_t boardSize = 8;
+    std::unique_ptr<Position> position = std::make_unique<Position>(boardSize);
+    Search search{0};
+    size_t hashMegabytes = 16;
+    std::unique_ptr<AnalysisCache> persistentCache;
+    std::unique_ptr<SearchTrace> trace;
+    std::unique_ptr<MemoryBudget> memory;
+    MemoryBudget::Account *tableMemory = nullptr;
+    MemoryBudget::Account *cacheMemory = nullptr;
+    MemoryBudget::Account *traceMemory = nullptr;
+    std::atomic<bool> stopSearch{false};
+    std::atomic<bool> searching{false}; // Cleared by the search thread just before bestmove
+    std::thread searchThread;
+    std::mutex outputMutex;
+    MoveTimeLog timeLog; // Only touched by the search thread or after joining it
+
+    void send(const std::string &line)
+    {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        std::cout << line << std::endl;
+    }
+
+    // Commands the search thread's state depends on; they wait for the search to end
+    static bool needsIdle(const std::string &command)
+    {
+        return command == "newgame" || command == "position" || command == "go" || command == "setoption" ||
+               command == "timestats";
+    }
+
+    void waitForSearch()
+    {
+        if (searchThread.joinable())
+            searchThread.join();
+    }
+
+    void newGame(std::istringstream &args)
+    {
+        size_t size = 0;
+        if (!(args >> size) || size < 3 || size > 51)
+        {
+            send("info string board size must be between 3 and 51");
+            return;
+        }
+        boardSize = size;
+        position = std::make_unique<Position>(boardSize);
+        search.clear();
+    }
+
+    void setPosition(std::istringstream &args)
+    {
+        auto next = std::make_unique<Position>(boardSize);
+        std::string text;
+        while (args >> text)
+        {
+            if (text == "startpos" || text == "moves")
+                continue;
+
+            if (text == "snapshot")
+            {
+                std::string path;
+                args >> path;
+                try
+                {
+                    next = std::make_unique<Position>(GameSnapshot::load(path).toPosition());
+                }
+                catch (const std::exception &ex)
+                {
+                    send(std::string("info string ") + ex.what());
+                    return;
+                }
+                continue;
+            }
+
+            Move move;
+            if (!next->parseMove(text, move))
+            {
+                send("info string illegal move " + text);
+                return;
+            }
+            next->makeMove(move);
+        }
+        if (next->getSize() != boardSize)
+        {
+            boardSize = next->getSize();
+            search.clear();
+        }
+        position = std::move(next);
+    }
+
+    void saveSnapshot(std::istringstream &args)
+    {
+        std::string path;
+        if (!(args >> path))
+        {
+            send("info string savesnapshot needs a path");
+            return;
+        }
+        try
+        {
+            GameSnapshot::fromPosition(*position).save(path);
+        }
+        catch (const std::exception &ex)
+        {
+            send(std::string("info string ") + ex.what());
+        }
+    }
+
+    void go(std::istringstream &args)
+    {
+        Search::Limits limits;
+        limits.stop = &stopSearch;
+        int64_t clockMs[2] = {-1, -1};
+        int64_t incrementMs[2] = {0, 0};
+        std::string token;
+        while (args >> token)
+        {
+            if (token == "depth")
+                args >> limits.depth;
+            else if (token == "nodes")
+                args >> limits.nodes;
+            else if (token == "movetime")
+                args >> limits.movetimeMs;
+            else if (token == "wtime")
+                args >> clockMs[0];
+            else if (token == "btime")
+                args >> clockMs[1];
+            else if (token == "winc")
+                args >> incrementMs[0];
+            else if (token == "binc")
+                args >> incrementMs[1];
+        }
+
+        // Budget the move from the clock of the side to move
+        const Position root = *position;
+        const int side = root.getSideToMove();
+        const bool timed = clockMs[side] >= 0;
+        if (timed)
+        {
+            const TimeManager::Budget budget = TimeManager::plan(root, clockMs[side], incrementMs[side]);
+            limits.softTimeMs = budget.softMs;
+            limits.movetimeMs = budget.hardMs;
+        }
+
+        stopSearch = false;
+        searching = true;
+        searchThread = std::thread([this, root, limits, timed, side]()
+                                   {
+            auto report = [this](const Search::Info &info)
+            {
+                std::ostringstream line;
+                line << "info depth " << info.depth << " score " << info.score
+                     << " nodes " << info.nodes
+                     << " nps " << static_cast<uint64_t>(info.nodes / std::max(info.seconds, 1e-6))
+                     << " time " << static_cast<uint64_t>(info.seconds * 1000);
+                send(line.str());
+            };
+
+            const auto start = std::chrono::steady_clock::now();
+            const Search::Info result = search.run(root, limits, report);
+            if (timed)
+            {
+                const int64_t usedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                           std::chrono::steady_clock::now() - start)
+                                           .count();
+                if (timeLog.record(side, usedMs, limits.movetimeMs))
+                    send("info string deadline missed: " + std::to_string(usedMs) + " ms of " +
+                         std::to_string(limits.movetimeMs));
+            }
+            searching = false;
+            send(result.hasMove ? "bestmove " + root.moveToString(result.bestMove) : "bestmove none"); });
+    }
+
+    void perft(std::istringstream &args)
+    {
+        int depth = 1;
+        args >> depth;
+
+        const auto start = std::chrono::steady_clock::now();
+        Position pos = *position;
+        Move moves[Position::MaxMoves];
+        const int count = pos.isGameOver() || depth < 1 ? 0 : pos.generateMoves(moves);
+
+        uint64_t total = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            const Position::Undo undo = pos.makeMove(moves[i]);
+            const uint64_t leaves = Search::perft(pos, depth - 1);
+            pos.unmakeMove(undo);
+            total += leaves;
+            send(pos.moveToString(moves[i]) + ": " + std::to_string(leaves));
+        }
+
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        send("nodes " + std::to_string(total) + " nps " +
+             std::to_string(static_cast<uint64_t>(total / std::max(seconds, 1e-6))));
+    }
+
+    // Size the table to the Hash option, or less if the memory limit says so
+    void resizeTable()
+    {
+        tableMemory->release(search.getTableBytes());
+        size_t bytes = hashMegabytes * 1024 * 1024;
+        if (tableMemory->getLimit() != 0 && bytes > tableMemory->getLimit())
+        {
+            bytes = tableMemory->getLimit();
+            send("info string Hash limited to " + std::to_string(bytes >> 20) + " MB by the memory limit");
+        }
+        search.resizeBytes(bytes);
+        tableMemory->charge(search.getTableBytes());
+    }
+
+    void closeCache()
+    {
+        search.setPersistentCache(nullptr);
+        if (persistentCache)
+            cacheMemory->release(persistentCache->getMappedBytes());
+        persistentCache.reset();
+    }
+
+    // A new file gets what the limit allows; an existing one that is too large is not used
+    void openCache(const std::string &path)
+    {
+        const size_t room = cacheMemory->available();
+        const size_t megabytes = std::min(CacheMegabytes, (room > 4096 ? room - 4096 : 0) >> 20); // Room for the header
+        if (megabytes == 0)
+        {
+            send("info string no memory left for the persistent cache");
+            return;
+        }
+        auto cache = std::make_unique<AnalysisCache>(path, megabytes);
+        if (!cacheMemory->tryCharge(cache->getMappedBytes()))
+        {
+            send("info string persistent cache " + path + " is larger than the memory limit allows");
+            return;
+        }
+        persistentCache = std::move(cache);
+        search.setPersistentCache(persistentCache.get());
+    }
+
+    void closeTrace()
+    {
+        search.setTrace(nullptr);
+        if (trace)
+            traceMemory->release(TraceBytes);
+        trace.reset();
+    }
+
+    void openTrace(const std::string &path)
+    {
+        if (!traceMemory->tryCharge(TraceBytes))
+        {
+            send("info string trace buffers do not fit the memory limit");
+            return;
+        }
+        try
+        {
+            trace = std::make_unique<SearchTrace>(path);
+        }
+        catch (...)
+        {
+            traceMemory->release(TraceBytes);
+            throw;
+        }
+        search.setTrace(trace->createWriter());
+    }
+
+    // Start a new budget; the table shrinks to fit, a cache or trace that does not fit is closed
+    void setMemoryLimit(size_t megabytes)
+    {
+        memory = std::make_unique<MemoryBudget>(megabytes * 1024 * 1024);
+        tableMemory = &memory->add("search table", TableShare);
+        cacheMemory = &memory->add("persistent cache", CacheShare);
+        traceMemory = &memory->add("trace buffers", TraceShare);
+        search.resize(0); // Nothing is charged yet, so let the old table go first
+        resizeTable();
+
+        if (persistentCache && !cacheMemory->tryCharge(persistentCache->getMappedBytes()))
+        {
+            send("info string persistent cache closed: larger than the memory limit allows");
+            search.setPersistentCache(nullptr);
+            persistentCache.reset();
+        }
+        if (trace && !traceMemory->tryCharge(TraceBytes))
+        {
+            send("info string trace closed: buffers do not fit the memory limit");
+            search.setTrace(nullptr);
+            trace.reset();
+        }
+    }
+
+    void setOption(std::istringstream &args)
+    {
+        std::string word, name, value;
+        args >> word >> name >> word >> value;
+        try
+        {
+            if (name == "Hash")
+            {
+                const size_t megabytes = std::strtoul(value.c_str(), nullptr, 10);
+                if (megabytes > 0)
+                {
+                    hashMegabytes = megabytes;
+                    resizeTable();
+                }
+            }
+            else if (name == "Memory")
+            {
+                setMemoryLimit(std::strtoul(value.c_str(), nullptr, 10));
+            }
+            else if (name == "PersistentCache")
+            {
+                closeCache();
+                if (!value.empty())
+                    openCache(value);
+            }
+            else if (name == "Trace")
+            {
+                closeTrace();
+                if (!value.empty())
+                    openTrace(value);
+            }
+        }
+        catch (const std::exception &e)
+        {
+            send(std::string("info string ") + e.what());
+        }
+    }
+
+public:
+    Engine()
+    {
+        setMemoryLimit(0);
+    }
+
+    ~Engine()
+    {
+        stopSearch = true;
+        waitForSearch();
+    }
+
+    void run()
+    {
+        std::string line;
+        while (std::getline(std::cin, line))
+        {
+            std::istringstream args(line);
+            std::string command;
+            args >> command;
+
+            // Only stop waits for a running search; the reader never blocks on it otherwise
+            if (command == "stop")
+            {
+                stopSearch = true;
+                waitForSearch();
+                continue;
+            }
+            if (command == "quit")
+                break;
+            if (searching && needsIdle(command))
+            {
+                send("info string search running, " + command + " ignored; send stop first");
+                continue;
+            }
+
+            if (!searching)
+                waitForSearch(); // Reap a search that has already sent bestmove
+            if (command == "newgame")
+                newGame(args);
+            else if (command == "position")
+                setPosition(args);
+            else if (command == "savesnapshot")
+                saveSnapshot(args);
+            else if (command == "go")
+                go(args);
+            else if (command == "perft")
+                perft(args);
+            else if (command == "setoption")
+                setOption(args);
+            else if (command == "timestats")
+            {
+                std::ostringstream stats;
+                timeLog.print(stats);
+                send(stats.str().empty() ? "info string no timed moves" : stats.str());
+            }
+            else if (command == "memstats")
+                send("info string memory " + MemoryBudget::describe(memory->usage()));
+            else if (command == "isready")
+                send("readyok");
+            else if (command == "print")
+            {
+                std::ostringstream board;
+                position->print(board);
+                send(board.str() + "side " + std::to_string(position->getSideToMove()));
+            }
+            else if (!command.empty())
+                send("info string unknown command " + command);
+        }
+    }
+};
+
+int main()
+{
+    std::ios::sync_with_stdio(false);
+    Engine engine;
+    engine.run();
+    return 0;
+}
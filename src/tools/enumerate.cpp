@@ -0,0 +1,53 @@
+#include "objects/StateEnumerator.h"
+#include <iostream>
+#include <string>
+#include <thread>
+
+static void printHistogram(const char *title, const std::vector<uint64_t> &histogram)
+{
+    std::cout << title << "\n";
+    for (size_t i = 0; i < histogram.size(); ++i)
+    {
+        if (histogram[i] != 0)
+            std::cout << "  " << i << ": " << histogram[i] << "\n";
+    }
+}
+
+// Usage: enumerate <board size> [memory MB] [threads] [temp dir]
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <board size> [memory MB] [threads] [temp dir]\n";
+        return 1;
+    }
+
+    const size_t size = std::stoul(argv[1]);
+    const size_t memoryMegabytes = argc > 2 ? std::stoul(argv[2]) : 1024;
+    const unsigned threads = argc > 3 ? std::stoul(argv[3]) : std::thread::hardware_concurrency();
+    const std::string tempDir = argc > 4 ? argv[4] : ".";
+
+    try
+    {
+        StateEnumerator enumerator(size, memoryMegabytes, threads, tempDir);
+        const StateEnumerator::Report report = enumerator.run([](size_t level, uint64_t positions)
+                                                              {
+            if (positions != 0)
+                std::cout << "level " << level << ": " << positions << " positions" << std::endl; });
+
+        std::cout << "Reachable positions: " << report.positions << "\n"
+                  << "Terminal positions: " << report.terminals << "\n"
+                  << "Spilled runs: " << report.spilledRuns << "\n"
+                  << "Time: " << report.seconds << "s ("
+                  << static_cast<uint64_t>(report.positions / std::max(report.seconds, 1e-3)) << " positions/s)\n";
+        printHistogram("Branching factor:", report.branching);
+        printHistogram("Shortest game length:", report.shortestGame);
+        printHistogram("Longest game length:", report.longestGame);
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include "objects/GameServer.h"
+#include "objects/ServerLoadTest.h"
+#include <sys/resource.h>
+#include <csignal>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+static GameServer *activeServer = nullptr;
+
+static void handleInterrupt(int)
+{
+    if (activeServer)
+        activeServer->stop();
+}
+
+// One descriptor per connection; allow as many as the hard limit does
+static void raiseFileLimit()
+{
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+static void printLatency(const std::string &label, uint32_t count, uint32_t p50, uint32_t p90, uint32_t p99, uint32_t max)
+{
+    std::cout << label << ": " << count << " samples, p50 " << p50 << " us, p90 " << p90 << " us, p99 " << p99
+              << " us, max " << max << " us\n";
+}
+
+static void printLatency(const std::string &label, const GameProtocol::LatencyHistogram &latency)
+{
+    printLatency(label, latency.count(), latency.percentile(0.5), latency.percentile(0.9), latency.percentile(0.99),
+                 latency.max());
+}
+
+// Usage: gameserver serve [port] [unix socket path | -] [threads] [memory MB] [bind address]
+//        gameserver bench <host | unix socket path> [port] [sessions] [connections] [seconds] [board size]
+// Port 0 disables TCP, memory 0 means no limit and TCP listens on loopback unless given an address. bench keeps that many games live and checks every reply.
+int main(int argc, char **argv)
+{
+    const std::string mode = argc > 1 ? argv[1] : "";
+    if ((mode != "serve" && mode != "bench") || (mode == "bench" && argc < 3))
+    {
+        std::cerr << "Usage: " << argv[0] << " serve [port] [unix socket path | -] [threads] [memory MB] [bind address]\n"
+                  << "       " << argv[0]
+                  << " bench <host | unix socket path> [port] [sessions] [connections] [seconds] [board size]\n";
+        return 1;
+    }
+    raiseFileLimit();
+
+    try
+    {
+        if (mode == "serve")
+        {
+            GameServer::Options options;
+            options.port = argc > 2 ? static_cast<uint16_t>(std::stoul(argv[2])) : options.port;
+            options.unixPath = argc > 3 && std::string(argv[3]) != "-" ? argv[3] : "";
+            options.threads = argc > 4 ? std::stoul(argv[4]) : std::max(1u, std::thread::hardware_concurrency());
+            options.memoryMegabytes = argc > 5 ? std::stoul(argv[5]) : options.memoryMegabytes;
+            options.address = argc > 6 ? argv[6] : options.address;
+
+            GameServer server(options);
+            activeServer = &server;
+            std::signal(SIGINT, handleInterrupt);
+            std::signal(SIGTERM, handleInterrupt);
+            std::cout << "Serving on " << (options.port ? options.address + ":" + std::to_string(options.port) : std::string("no port"))
+                      << (options.unixPath.empty() ? "" : " and " + options.unixPath) << " with " << options.threads
+                      << " workers"
+                      << (options.memoryMegabytes ? " in " + std::to_string(options.memoryMegabytes) + " MB" : "")
+                      << std::endl;
+
+            const GameServer::Report report = server.run([](const GameServer::Stats &stats)
+                                                         {
+                std::cout << std::fixed << std::setprecision(1) << stats.seconds << "s sessions " << stats.sessions
+                          << " connections " << stats.connections << " requests " << stats.requests << " ("
+                          << stats.intervalRequests << " in interval) p50 " << stats.intervalLatency.percentile(0.5)
+                          << " us p99 " << stats.intervalLatency.percentile(0.99) << " us max "
+                          << stats.intervalLatency.max() << " us\n  memory: " << MemoryBudget::describe(stats.memory)
+                          << std::endl; });
+            activeServer = nullptr;
+
+            std::cout << "Requests: " << report.requests << " in " << std::setprecision(1) << report.seconds << "s\n"
+                      << "Sessions: " << report.sessionsCreated << " created, peak " << report.peakSessions
+                      << " live, peak " << report.peakConnections << " connections, " << report.sessionsEvicted
+                      << " closed for memory\n";
+            printLatency("Latency", report.latency);
+            std::cout << "Peak memory:";
+            for (const MemoryBudget::Usage &usage : report.memory)
+                std::cout << " " << usage.name << " " << usage.peak / 1048576.0 << " MB";
+            std::cout << "\n";
+        }
+        else
+        {
+            ServerLoadTest::Options options;
+            options.address = argv[2];
+            options.port = argc > 3 ? static_cast<uint16_t>(std::stoul(argv[3])) : options.port;
+            options.sessions = argc > 4 ? std::stoul(argv[4]) : options.sessions;
+            options.connections = argc > 5 ? std::stoul(argv[5]) : options.connections;
+            options.seconds = argc > 6 ? std::stod(argv[6]) : options.seconds;
+            options.boardSize = argc > 7 ? std::stoul(argv[7]) : options.boardSize;
+
+            ServerLoadTest test(options);
+            const ServerLoadTest::Report report = test.run();
+            std::cout << "Games: " << report.games << ", moves: " << report.moves << " in " << std::fixed
+                      << std::setprecision(1) << report.seconds << "s ("
+                      << static_cast<uint64_t>(report.moves / std::max(report.seconds, 1e-3)) << " moves/s), peak "
+                      << report.peakSessions << " live sessions\n"
+                      << "Errors: " << report.errors << ", mismatches: " << report.mismatches << "\n";
+            printLatency("Round trip", report.roundTrip);
+            printLatency("Server", report.server[0], report.server[1], report.server[2], report.server[3], report.server[4]);
+            return report.errors || report.mismatches ? 1 : 0;
+        }
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include "objects/TrainingGenerator.h"
+#include <csignal>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+static TrainingGenerator *activeGenerator = nullptr;
+
+static void handleInterrupt(int)
+{
+    if (activeGenerator)
+        activeGenerator->stop();
+}
+
+static int verify(const std::string &directory)
+{
+    size_t good = 0, bad = 0;
+    uint64_t samples = 0;
+    for (size_t index = 0;; ++index)
+    {
+        const std::string path = TrainingGenerator::shardPath(directory, index);
+        if (!std::filesystem::exists(path))
+            break;
+
+        TrainingGenerator::Header header{};
+        if (TrainingGenerator::verifyShard(path, header))
+        {
+            ++good;
+            samples += header.recordCount;
+        }
+        else
+        {
+            ++bad;
+            std::cout << path << ": corrupt or incomplete\n";
+        }
+    }
+    std::cout << good << " good shards, " << bad << " bad, " << samples << " samples\n";
+    return bad == 0 ? 0 : 1;
+}
+
+// Usage: gendata <board size> <samples> <output dir> [threads] [search depth] [seed]
+//        gendata verify <output dir>
+int main(int argc, char **argv)
+{
+    if (argc == 3 && std::string(argv[1]) == "verify")
+        return verify(argv[2]);
+
+    if (argc < 4)
+    {
+        std::cerr << "Usage: " << argv[0] << " <board size> <samples> <output dir> [threads] [search depth] [seed]\n"
+                  << "       " << argv[0] << " verify <output dir>\n";
+        return 1;
+    }
+
+    TrainingGenerator::Options options;
+    options.boardSize = std::stoul(argv[1]);
+    options.samples = std::stoull(argv[2]);
+    options.directory = argv[3];
+    options.threads = argc > 4 ? std::stoul(argv[4]) : std::thread::hardware_concurrency();
+    options.searchDepth = argc > 5 ? std::stoi(argv[5]) : options.searchDepth;
+    options.seed = argc > 6 ? std::stoull(argv[6]) : options.seed;
+
+    try
+    {
+        TrainingGenerator generator(options);
+        activeGenerator = &generator;
+        std::signal(SIGINT, handleInterrupt);
+        std::signal(SIGTERM, handleInterrupt);
+
+        uint64_t lastSamples = 0, lastBytes = 0;
+        double lastSeconds = 0;
+        const TrainingGenerator::Report report = generator.run([&](const TrainingGenerator::Progress &progress)
+                                                               {
+            const double interval = std::max(progress.seconds - lastSeconds, 1e-3);
+            std::cout << std::fixed << std::setprecision(1) << progress.seconds << "s shards "
+                      << progress.shardsDone << "/" << progress.shardsTotal << " samples/s "
+                      << static_cast<uint64_t>((progress.samples - lastSamples) / interval) << " MB/s "
+                      << (progress.bytes - lastBytes) / interval / (1024 * 1024) << std::endl;
+            lastSamples = progress.samples;
+            lastBytes = progress.bytes;
+            lastSeconds = progress.seconds; });
+        activeGenerator = nullptr;
+
+        const double seconds = std::max(report.seconds, 1e-3);
+        std::cout << "Shards written: " << report.shardsWritten << " (" << report.shardsSkipped
+                  << " already complete)\n"
+                  << "Samples: " << report.samples << " in " << std::setprecision(1) << report.seconds << "s ("
+                  << static_cast<uint64_t>(report.samples / seconds) << " samples/s, "
+                  << report.bytes / seconds / (1024 * 1024) << " MB/s)\n";
+        if (report.interrupted)
+        {
+            std::cout << "Interrupted; run the same command again to resume\n";
+            return 1;
+        }
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
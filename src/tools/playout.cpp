@@ -0,0 +1,171 @@
+#include "objects/BatchPlayout.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static uint64_t occupancy(const Position &pos, int player)
+{
+    const BoardGrid &grid = pos.getGrid();
+    uint64_t bits = 0;
+    for (size_t y = 0; y < grid.getHeight(); ++y)
+    {
+        for (size_t x = 0; x < grid.getWidth(); ++x)
+        {
+            const size_t idx = grid.index(x, y);
+            if (grid.isOccupied(idx) && BoardGrid::cellPlayer(grid.at(idx)) == player)
+                bits |= 1ULL << (y * BatchPlayout<>::MaxBoardSize + x);
+        }
+    }
+    return bits;
+}
+
+static int bitIndex(uint64_t bit)
+{
+    int index = 0;
+    while (bit > 1)
+    {
+        bit >>= 1;
+        ++index;
+    }
+    return index;
+}
+
+// Step the kernel next to one Position per lane; throws on the first move or outcome they disagree on
+static void verify(const Position &start, uint64_t games, uint64_t seed)
+{
+    BatchPlayout<> batch;
+    batch.reset(start, seed);
+    std::vector<Position> mirrors(batch.lanes(), start);
+    const int width = BatchPlayout<>::MaxBoardSize;
+
+    uint64_t finished = 0;
+    for (uint64_t step = 0; finished < games; ++step)
+    {
+        batch.step();
+
+        for (size_t lane = 0; lane < batch.lanes(); ++lane)
+        {
+            Position &mirror = mirrors[lane];
+            const int from = bitIndex(batch.getLastFrom(lane));
+            const int to = bitIndex(batch.getLastTo(lane));
+            const std::string where = "step " + std::to_string(step) + " lane " + std::to_string(lane) + ": ";
+            Move move;
+            if (!mirror.findMove(from % width, from / width, to % width, to / width, move) ||
+                move.to != mirror.getGrid().index(to % width, to / width))
+                throw std::runtime_error(where + "illegal move " + std::to_string(from) + "-" + std::to_string(to));
+            mirror.makeMove(move);
+
+            const BatchPlayout<>::Outcome outcome = batch.getOutcome(lane);
+            if (outcome != BatchPlayout<>::Playing)
+            {
+                const int winner = outcome == BatchPlayout<>::Blocked ? -1 : outcome - BatchPlayout<>::Player0Won;
+                if (!mirror.isGameOver() || mirror.winner() != winner)
+                    throw std::runtime_error(where + "game ended differently");
+                mirror = start;
+                ++finished;
+            }
+            else if (mirror.isGameOver())
+            {
+                throw std::runtime_error(where + "game should have ended");
+            }
+            if (occupancy(mirror, 0) != batch.getTokens(lane, 0) || occupancy(mirror, 1) != batch.getTokens(lane, 1) ||
+                mirror.getSideToMove() != batch.getSideToMove(lane))
+                throw std::runtime_error(where + "boards differ");
+        }
+    }
+}
+
+// One game at a time on Position, choosing uniformly among the generated moves
+static PlayoutTotals positionPlayouts(const Position &start, uint64_t games, uint64_t seed)
+{
+    PlayoutTotals totals;
+    Move moves[Position::MaxMoves];
+    uint64_t random = mixHash(seed) | 1;
+    Position pos = start;
+    for (; totals.games < games; ++totals.games)
+    {
+        pos = start;
+        while (!pos.isGameOver())
+        {
+            random ^= random << 13;
+            random ^= random >> 7;
+            random ^= random << 17;
+            const int count = pos.generateMoves(moves);
+            pos.makeMove(moves[((random >> 32) * count) >> 32]);
+            ++totals.plies;
+        }
+        const int winner = pos.winner();
+        if (winner < 0)
+            ++totals.blocked;
+        else
+            ++totals.wins[winner];
+    }
+    return totals;
+}
+
+static void report(const char *name, const PlayoutTotals &totals, double seconds, double baseline)
+{
+    const double gamesPerSecond = totals.games / std::max(seconds, 1e-9);
+    std::cout << "  " << std::setw(18) << std::left << name << std::right << std::setw(12)
+              << static_cast<uint64_t>(gamesPerSecond) << " games/s" << std::setw(13)
+              << static_cast<uint64_t>(totals.plies / std::max(seconds, 1e-9)) << " plies/s";
+    if (baseline > 0)
+        std::cout << std::setw(8) << std::setprecision(1) << gamesPerSecond / baseline << "x";
+    std::cout << "   player 0 " << std::setprecision(3) << 100.0 * totals.wins[0] / std::max<uint64_t>(totals.games, 1)
+              << "%, player 1 " << 100.0 * totals.wins[1] / std::max<uint64_t>(totals.games, 1) << "%, blocked "
+              << 100.0 * totals.blocked / std::max<uint64_t>(totals.games, 1) << "%\n";
+}
+
+template <size_t Lanes>
+static void timeBatch(const Position &start, uint64_t games, uint64_t seed, double baseline)
+{
+    BatchPlayout<Lanes> batch;
+    batch.reset(start, seed);
+    const auto startTime = std::chrono::steady_clock::now();
+    const PlayoutTotals totals = batch.run(games);
+    const std::string name = "batch, " + std::to_string(Lanes) + " lanes";
+    report(name.c_str(), totals, secondsSince(startTime), baseline);
+}
+
+// Usage: playout [board size] [games] [seed]
+// Random playouts from the start position on the batch kernel, checked against Position and timed against it.
+int main(int argc, char **argv)
+{
+    const size_t size = argc > 1 ? std::stoul(argv[1]) : 6;
+    const uint64_t games = argc > 2 ? std::stoull(argv[2]) : 2000000;
+    const uint64_t seed = argc > 3 ? std::stoull(argv[3]) : 1;
+
+    try
+    {
+        if (size < 3 || size > BatchPlayout<>::MaxBoardSize)
+            throw std::runtime_error("Board size must lie between 3 and 8");
+        const Position start(size);
+
+        const uint64_t checked = std::min<uint64_t>(games, 100000);
+        verify(start, checked, seed);
+        std::cout << "Checked " << checked << " batch games against Position on " << size << "x" << size << "\n";
+
+        std::cout << std::fixed;
+        const auto startTime = std::chrono::steady_clock::now();
+        const PlayoutTotals single = positionPlayouts(start, games, seed);
+        const double seconds = secondsSince(startTime);
+        report("Position, 1 game", single, seconds, 0);
+        const double baseline = single.games / std::max(seconds, 1e-9);
+        timeBatch<8>(start, games, seed, baseline);
+        timeBatch<16>(start, games, seed, baseline);
+        timeBatch<32>(start, games, seed, baseline);
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
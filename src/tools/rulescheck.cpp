@@ -0,0 +1,361 @@
+#include "objects/GameBoard.h"
+#include "objects/GameSate.h"
+#include "objects/RulesHarness.h"
+#include <chrono>
+#include <csignal>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+// Reference: GameBoard and its Tokens exactly as the game uses them
+class GameBoardKernel
+{
+private:
+    static constexpr uint8_t Inconsistent = 16; // Token flag disagrees with canTokenMove()
+
+    sf::Texture texture; // Never drawn; tokens only need something to refer to
+    std::unique_ptr<GameBoard> board;
+    std::vector<std::unique_ptr<Token>> tokens;
+    size_t size = 0;
+
+public:
+    void reset(size_t boardSize)
+    {
+        size = boardSize;
+        board = std::make_unique<GameBoard>(size, size);
+        tokens.clear();
+        for (size_t i = 0; i < size - 2; ++i)
+        {
+            tokens.push_back(std::make_unique<Token>(0, i + 1, 0, texture, 1.0f, 1.0f));
+            board->placeToken(tokens.back().get());
+            tokens.push_back(std::make_unique<Token>(i + 1, 0, 1, texture, 1.0f, 1.0f));
+            board->placeToken(tokens.back().get());
+        }
+    }
+
+    MoveResult checkMove(int fromX, int fromY, int toX, int toY) const
+    {
+        // getTokenMove() is checkMove() without the status
+        const MoveResult result = board->checkMove(fromX, fromY, toX, toY);
+        const std::pair<int, int> target = board->getTokenMove(fromX, fromY, toX, toY);
+        if (result.ok() != (target.first >= 0) || (result.ok() && target != std::make_pair(result.x, result.y)))
+            return {MoveStatus::Ok, -2, -2};
+        return result;
+    }
+
+    MoveStatus move(int fromX, int fromY, int toX, int toY)
+    {
+        return board->tryMoveToken(fromX, fromY, toX, toY).status;
+    }
+
+    uint8_t observeCell(int x, int y) const
+    {
+        using Harness = DifferentialHarness<GameBoardKernel, GameBoardKernel>;
+        const Token *token = board->getTokenAt(x, y);
+        if (!token)
+            return 0;
+        uint8_t cell = token->getPlayer() == 0 ? Harness::Player0 : Harness::Player1;
+        if (token->isMovable())
+            cell |= Harness::Movable;
+        if (token->hasReachedEnd())
+            cell |= Harness::ReachedEnd;
+        if (token->isMovable() != board->canTokenMove(token))
+            cell |= Inconsistent;
+        return cell;
+    }
+
+    void observe(std::vector<uint8_t> &cells) const
+    {
+        cells.assign(size * size, 0);
+        for (size_t y = 0; y < size; ++y)
+        {
+            for (size_t x = 0; x < size; ++x)
+                cells[y * size + x] = observeCell(static_cast<int>(x), static_cast<int>(y));
+        }
+    }
+};
+
+// Candidate: the Position rules the search runs on, behind GameBoard's interface
+class PositionKernel
+{
+private:
+    std::unique_ptr<Position> pos;
+
+public:
+    void reset(size_t size)
+    {
+        pos = std::make_unique<Position>(size);
+    }
+
+    // findMove() decides the move; the statuses only name why it found none
+    MoveResult checkMove(int fromX, int fromY, int toX, int toY) const
+    {
+        const BoardGrid &grid = pos->getGrid();
+        if (!grid.isValidPosition(fromX, fromY) || !grid.isValidPosition(toX, toY))
+            return {MoveStatus::OutOfBounds, -1, -1};
+        const size_t from = grid.index(fromX, fromY);
+        if (!grid.isOccupied(from))
+            return {MoveStatus::NoToken, -1, -1};
+        if (!grid.canMove(from))
+            return {MoveStatus::Immovable, -1, -1};
+
+        // GameBoard leaves the turn to its caller, so probe either player's tokens
+        const int player = BoardGrid::cellPlayer(grid.at(from));
+        Move move;
+        const bool found = player == pos->getSideToMove() ? pos->findMove(fromX, fromY, toX, toY, move)
+                                                          : Position(grid, player).findMove(fromX, fromY, toX, toY, move);
+        if (!found)
+            return {MoveStatus::IllegalMove, -1, -1};
+        return {MoveStatus::Ok, grid.column(move.to), grid.row(move.to)};
+    }
+
+    MoveStatus move(int fromX, int fromY, int toX, int toY)
+    {
+        const MoveResult result = checkMove(fromX, fromY, toX, toY);
+        if (!result.ok())
+            return result.status;
+
+        // Position only moves the side to move; anything else is a turn-order disagreement
+        Move move;
+        if (!pos->findMove(fromX, fromY, toX, toY, move))
+            return MoveStatus::NoToken;
+        pos->makeMove(move);
+        return MoveStatus::Ok;
+    }
+
+    uint8_t observeCell(int x, int y) const
+    {
+        using Harness = DifferentialHarness<PositionKernel, PositionKernel>;
+        const BoardGrid &grid = pos->getGrid();
+        const size_t idx = grid.index(x, y);
+        if (!grid.isOccupied(idx))
+            return 0;
+        const int player = BoardGrid::cellPlayer(grid.at(idx));
+        uint8_t cell = player == 0 ? Harness::Player0 : Harness::Player1;
+        if (grid.canMove(idx))
+            cell |= Harness::Movable;
+        if (static_cast<size_t>(player == 0 ? x : y) == grid.getWidth() - 1)
+            cell |= Harness::ReachedEnd;
+        return cell;
+    }
+
+    void observe(std::vector<uint8_t> &cells) const
+    {
+        const size_t size = pos->getGrid().getWidth();
+        cells.assign(size * size, 0);
+        for (size_t y = 0; y < size; ++y)
+        {
+            for (size_t x = 0; x < size; ++x)
+                cells[y * size + x] = observeCell(static_cast<int>(x), static_cast<int>(y));
+        }
+    }
+};
+
+using Harness = DifferentialHarness<GameBoardKernel, PositionKernel>;
+
+// Bulk replay: GameState::applyMoves() against one move at a time, as GameManager plays them
+class BatchReplayCheck
+{
+public:
+    struct Report
+    {
+        uint64_t games = 0;
+        uint64_t moves = 0;
+        std::string mismatch; // Empty if every replay agreed
+        double perMoveRate = 0; // Moves per second on the largest board
+        double batchRate = 0;
+    };
+
+private:
+    sf::Texture texture; // Never drawn
+
+    std::unique_ptr<GameState> newState(size_t size) const
+    {
+        return std::make_unique<GameState>(1.0f, 1.0f, size, texture, texture);
+    }
+
+    static std::string describe(const GameState &state)
+    {
+        return state.toSnapshot("", "").encode();
+    }
+
+    // Random game on the Position rules, with now and then one move corrupted
+    static std::vector<Move> randomGame(size_t size, std::mt19937_64 &rng, bool corrupt)
+    {
+        Position pos(size);
+        std::vector<Move> moves;
+        Move legal[Position::MaxMoves];
+        while (!pos.isGameOver())
+        {
+            const int count = pos.generateMoves(legal);
+            moves.push_back(legal[rng() % count]);
+            pos.makeMove(moves.back());
+        }
+        if (corrupt && !moves.empty())
+        {
+            Move &move = moves[rng() % moves.size()];
+            const BoardGrid &grid = pos.getGrid();
+            move.from = static_cast<uint16_t>(rng() % grid.size());
+            move.to = static_cast<uint16_t>(rng() % 2 ? move.from + grid.forwardOffset(rng() % 2) : rng() % grid.size());
+        }
+        return moves;
+    }
+
+    // One tryMoveToken() per move, handing the turn on like GameManager; returns the moves applied
+    static size_t playOneByOne(GameState &state, const std::vector<Move> &moves, size_t size)
+    {
+        // The Position rules say which move is the first illegal one
+        Position pos(size);
+        const BoardGrid &grid = pos.getGrid();
+        for (size_t i = 0; i < moves.size(); ++i)
+        {
+            const int fromX = grid.column(moves[i].from), fromY = grid.row(moves[i].from);
+            const int toX = grid.column(moves[i].to), toY = grid.row(moves[i].to);
+            Move move;
+            if (!pos.findMove(fromX, fromY, toX, toY, move))
+                return i;
+            pos.makeMove(move);
+            state.tryMoveToken(fromX, fromY, toX, toY);
+            if (state.getOtherPlayer().getMovableTokens() != 0)
+                state.switchPlayer();
+        }
+        return moves.size();
+    }
+
+public:
+    Report run(uint64_t games, uint64_t seed, size_t maxSize)
+    {
+        Report report;
+        std::mt19937_64 rng(mixHash(seed ^ 0x6261746368ULL));
+        for (; report.games < games && report.mismatch.empty(); ++report.games)
+        {
+            const size_t size = 3 + rng() % (maxSize - 2);
+            const std::vector<Move> moves = randomGame(size, rng, rng() % 4 == 0);
+            report.moves += moves.size();
+
+            std::unique_ptr<GameState> expected = newState(size), actual = newState(size);
+            const size_t applied = playOneByOne(*expected, moves, size);
+            const GameBoard::BatchResult result = actual->applyMoves(moves.data(), moves.size());
+            if (result.applied != applied || result.ok() != (applied == moves.size()))
+                report.mismatch = "applied " + std::to_string(result.applied) + " of " + std::to_string(moves.size()) +
+                                  " moves (" + moveStatusMessage(result.status) + "), expected " + std::to_string(applied);
+            else if (describe(*actual) != describe(*expected))
+                report.mismatch = "final state differs after " + std::to_string(applied) + " moves";
+            if (!report.mismatch.empty())
+                report.mismatch = "game " + std::to_string(report.games) + " on " + std::to_string(size) + "x" +
+                                  std::to_string(size) + ": " + report.mismatch;
+        }
+        if (!report.mismatch.empty())
+            return report;
+
+        // Timed on the largest board, where a per-move refresh costs most
+        std::vector<std::vector<Move>> timed;
+        for (int i = 0; i < 200; ++i)
+            timed.push_back(randomGame(maxSize, rng, false));
+        auto rate = [&](bool batch)
+        {
+            std::vector<std::unique_ptr<GameState>> states;
+            for (size_t i = 0; i < timed.size(); ++i)
+                states.push_back(newState(maxSize));
+            uint64_t moves = 0;
+            const auto startTime = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < timed.size(); ++i)
+            {
+                if (batch)
+                {
+                    states[i]->applyMoves(timed[i].data(), timed[i].size());
+                }
+                else
+                {
+                    for (const Move &move : timed[i])
+                    {
+                        const BoardGrid &grid = states[i]->getBoard().getGrid();
+                        states[i]->tryMoveToken(grid.column(move.from), grid.row(move.from), grid.column(move.to),
+                                                grid.row(move.to));
+                        if (states[i]->getOtherPlayer().getMovableTokens() != 0)
+                            states[i]->switchPlayer();
+                    }
+                }
+                moves += timed[i].size();
+            }
+            return moves / std::max(std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count(), 1e-9);
+        };
+        report.perMoveRate = rate(false);
+        report.batchRate = rate(true);
+        return report;
+    }
+};
+
+static Harness *activeHarness = nullptr;
+
+static void handleInterrupt(int)
+{
+    if (activeHarness)
+        activeHarness->stop();
+}
+
+// Usage: rulescheck [moves] [threads] [seed] [max board size]
+int main(int argc, char **argv)
+{
+    Harness::Options options;
+    options.moves = argc > 1 ? std::stoull(argv[1]) : options.moves;
+    options.threads = argc > 2 ? std::stoul(argv[2]) : std::thread::hardware_concurrency();
+    options.seed = argc > 3 ? std::stoull(argv[3]) : options.seed;
+    options.maxSize = argc > 4 ? std::stoul(argv[4]) : options.maxSize;
+
+    try
+    {
+        Harness harness(options);
+        activeHarness = &harness;
+        std::signal(SIGINT, handleInterrupt);
+        std::signal(SIGTERM, handleInterrupt);
+
+        const Harness::Report report = harness.run([](const Harness::Progress &progress)
+                                                   { std::cout << std::fixed << std::setprecision(1) << progress.seconds
+                                                               << "s games " << progress.games << " moves " << progress.moves
+                                                               << " probes " << progress.probes << " ("
+                                                               << static_cast<uint64_t>(progress.moves / std::max(progress.seconds, 1e-3))
+                                                               << " moves/s)" << std::endl; });
+        activeHarness = nullptr;
+
+        std::cout << "Games: " << report.games << ", moves: " << report.moves << ", probes: " << report.probes
+                  << " in " << std::setprecision(1) << report.seconds << "s\n";
+        if (!report.passed)
+        {
+            const Harness::Mismatch &mismatch = report.mismatch;
+            std::cout << "MISMATCH in game " << mismatch.game << " on " << mismatch.boardSize << "x"
+                      << mismatch.boardSize << ", shrunk to " << mismatch.actions.size() << " actions:\n";
+            for (const Harness::Action &action : mismatch.actions)
+                std::cout << "  " << Harness::describe(action) << "\n";
+            std::cout << mismatch.description << "\n";
+            return 1;
+        }
+
+        std::cout << "No differences\n"
+                  << "Reference (GameBoard): " << static_cast<uint64_t>(report.referenceActionsPerSecond)
+                  << " actions/s\n"
+                  << "Candidate (Position): " << static_cast<uint64_t>(report.candidateActionsPerSecond)
+                  << " actions/s (" << std::setprecision(2)
+                  << report.candidateActionsPerSecond / std::max(report.referenceActionsPerSecond, 1.0) << "x)\n";
+
+        const BatchReplayCheck::Report batch = BatchReplayCheck().run(20000, options.seed, options.maxSize);
+        if (!batch.mismatch.empty())
+        {
+            std::cout << "BATCH REPLAY MISMATCH in " << batch.mismatch << "\n";
+            return 1;
+        }
+        std::cout << "Batch replay agrees on " << batch.games << " games, " << batch.moves << " moves\n"
+                  << "Replay on " << options.maxSize << "x" << options.maxSize << ": one by one "
+                  << static_cast<uint64_t>(batch.perMoveRate) << " moves/s, applyMoves "
+                  << static_cast<uint64_t>(batch.batchRate) << " moves/s (" << std::setprecision(1)
+                  << batch.batchRate / std::max(batch.perMoveRate, 1.0) << "x)\n";
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
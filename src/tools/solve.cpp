@@ -0,0 +1,92 @@
+#include "objects/GameSnapshot.h"
+#include "objects/ProofSolver.h"
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+// Usage: solve <board size | snapshot file> [table MB] [results file] [cache file]
+// Pass "-" as the results file to use a cache without exporting results.
+// A snapshot is solved for its side to move.
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <board size | snapshot file> [table MB] [results file] [cache file]\n";
+        return 1;
+    }
+
+    // Anything that is not a plain number is taken as a snapshot file
+    const std::string startArg = argv[1];
+    std::unique_ptr<Position> start;
+    if (startArg.find_first_not_of("0123456789") != std::string::npos)
+    {
+        try
+        {
+            start = std::make_unique<Position>(GameSnapshot::load(startArg).toPosition());
+        }
+        catch (const std::exception &ex)
+        {
+            std::cerr << "Error: " << ex.what() << "\n";
+            return 1;
+        }
+    }
+    const int size = start ? static_cast<int>(start->getSize()) : std::stoi(startArg);
+    const size_t tableMegabytes = argc > 2 ? std::stoul(argv[2]) : 1024;
+    const std::string resultsPath = argc > 3 ? argv[3] : "";
+    const std::string cachePath = argc > 4 ? argv[4] : "";
+
+    if (size < 3 || size > 51)
+    {
+        std::cerr << "Board size must be between 3 and 51\n";
+        return 1;
+    }
+
+    ProofSolver solver(tableMegabytes);
+
+    // Positions proven by earlier runs are looked up instead of searched again
+    std::unique_ptr<AnalysisCache> cache;
+    if (!cachePath.empty())
+    {
+        cache = std::make_unique<AnalysisCache>(cachePath, 1024);
+        solver.setPersistentCache(cache.get());
+    }
+    solver.setProgressCallback([](const ProofSolver::Progress &progress)
+                               {
+        std::cout << std::fixed << std::setprecision(1)
+                  << progress.seconds << "s nodes " << progress.nodes
+                  << " nps " << static_cast<uint64_t>(progress.nodes / std::max(progress.seconds, 1e-3))
+                  << " root pn " << progress.rootPn << " dn " << progress.rootDn
+                  << " table " << 100.0 * progress.entriesUsed / progress.entriesTotal << "%\n"; },
+                               1 << 22);
+
+    const std::string mover = start ? "Player " + std::to_string(start->getSideToMove() + 1) + " (to move)"
+                                    : "Player 1 (first to move)";
+    if (!start)
+        start = std::make_unique<Position>(size);
+    const ProofSolver::Result result = solver.solve(*start);
+
+    switch (result)
+    {
+    case ProofSolver::Result::Win:
+        std::cout << mover << " wins on " << size << "x" << size << "\n";
+        break;
+    case ProofSolver::Result::NoWin:
+        std::cout << mover << " cannot force a win on " << size << "x" << size << "\n";
+        break;
+    case ProofSolver::Result::Unknown:
+        std::cout << "Unresolved after " << solver.getNodes() << " nodes\n";
+        break;
+    }
+
+    if (!resultsPath.empty() && resultsPath != "-")
+    {
+        if (!solver.exportResults(resultsPath, size))
+        {
+            std::cerr << "Failed to write " << resultsPath << "\n";
+            return 1;
+        }
+        std::cout << "Results written to " << resultsPath << "\n";
+    }
+    return 0;
+}
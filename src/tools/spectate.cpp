@@ -0,0 +1,135 @@
+#include "objects/SpectatorWall.h"
+#include "objects/Search.h"
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Plays every board handled by one thread, one move per board per tick
+static void playGames(SpectatorWall &wall, unsigned first, unsigned stride, size_t boardSize,
+                      int depth, int moveDelayMs, const std::atomic<bool> &quit)
+{
+    struct Game
+    {
+        size_t slot;
+        Position pos;
+        int ply;
+        int finishedTicks;
+    };
+
+    std::vector<Game> games;
+    for (size_t slot = first; slot < wall.getBoardCount(); slot += stride)
+        games.push_back({slot, Position(boardSize), 0, 0});
+
+    Search search(16);
+    std::mt19937_64 rng(first + 1);
+    Move moves[Position::MaxMoves];
+    Search::Limits limits;
+    limits.depth = depth;
+    limits.nodes = 20000;
+
+    while (!quit)
+    {
+        const auto tickEnd = std::chrono::steady_clock::now() + std::chrono::milliseconds(moveDelayMs);
+        for (Game &game : games)
+        {
+            // Leave a finished game up for a moment, then start over
+            if (game.pos.isGameOver())
+            {
+                if (++game.finishedTicks * moveDelayMs < 2000)
+                    continue;
+                game.pos = Position(boardSize);
+                game.ply = 0;
+                game.finishedTicks = 0;
+            }
+            else if (game.ply < 2)
+            {
+                // Random first moves so the boards do not all play the same game
+                const int count = game.pos.generateMoves(moves);
+                game.pos.makeMove(moves[rng() % count]);
+                ++game.ply;
+            }
+            else
+            {
+                const Search::Info info = search.run(game.pos, limits);
+                game.pos.makeMove(info.bestMove);
+                ++game.ply;
+            }
+            wall.publish(game.slot, game.pos);
+        }
+        std::this_thread::sleep_until(tickEnd);
+    }
+}
+
+// Usage: spectate [boards] [board size] [threads] [search depth] [move delay ms]
+int main(int argc, char **argv)
+{
+    const size_t boards = argc > 1 ? std::stoul(argv[1]) : 64;
+    const size_t boardSize = argc > 2 ? std::stoul(argv[2]) : 15;
+    const unsigned threads = argc > 3 ? std::stoul(argv[3]) : std::max(std::thread::hardware_concurrency(), 1u);
+    const int depth = argc > 4 ? std::stoi(argv[4]) : 3;
+    const int moveDelayMs = argc > 5 ? std::stoi(argv[5]) : 100;
+
+    try
+    {
+        AssetCache assets;
+        sf::RenderWindow window(sf::VideoMode({1200, 1000}), "Spectator wall");
+        window.setFramerateLimit(60);
+        SpectatorWall wall(boards, boardSize, sf::Vector2f(window.getSize()), assets);
+
+        std::atomic<bool> quit{false};
+        std::vector<std::thread> players;
+        for (unsigned t = 0; t < threads && t < boards; ++t)
+            players.emplace_back(playGames, std::ref(wall), t, threads, boardSize, depth, moveDelayMs, std::cref(quit));
+
+        // Frame rate and worst frame time in the title, refreshed every second
+        sf::Clock frameClock, reportClock;
+        int frames = 0;
+        float worstFrame = 0;
+        while (window.isOpen())
+        {
+            while (auto event = window.pollEvent())
+            {
+                if (event->is<sf::Event::Closed>())
+                    window.close();
+                if (auto *keyPress = event->getIf<sf::Event::KeyPressed>())
+                {
+                    if (keyPress->code == sf::Keyboard::Key::Escape)
+                        window.close();
+                }
+            }
+
+            window.clear(sf::Color(60, 60, 60));
+            wall.draw(window);
+            window.display();
+
+            ++frames;
+            worstFrame = std::max(worstFrame, frameClock.restart().asSeconds());
+            if (reportClock.getElapsedTime().asSeconds() >= 1.0f)
+            {
+                std::ostringstream title;
+                title << "Spectator wall - " << boards << " boards - " << std::fixed << std::setprecision(1)
+                      << frames / reportClock.restart().asSeconds() << " fps, worst frame "
+                      << worstFrame * 1000 << " ms";
+                window.setTitle(title.str());
+                frames = 0;
+                worstFrame = 0;
+            }
+        }
+
+        quit = true;
+        for (std::thread &player : players)
+            player.join();
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
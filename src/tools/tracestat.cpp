@@ -0,0 +1,108 @@
+#include "objects/TraceSummary.h"
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+static double percent(uint64_t part, uint64_t whole)
+{
+    return whole ? 100.0 * part / whole : 0.0;
+}
+
+static double ratio(uint64_t part, uint64_t whole)
+{
+    return whole ? static_cast<double>(part) / whole : 0.0;
+}
+
+// Usage: tracestat <trace file> [hot subtrees]
+// Summarizes a trace written by the engine's "setoption name Trace value <path>".
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <trace file> [hot subtrees]\n";
+        return 1;
+    }
+
+    try
+    {
+        TraceSummary summary(argc > 2 ? std::stoul(argv[2]) : 10);
+        summary.read(argv[1]);
+        const auto &runs = summary.getRuns();
+        std::cout << std::fixed << std::setprecision(2)
+                  << "Records: " << summary.getRecords() << " in " << runs.size() << " searches\n";
+
+        std::cout << "Nodes by reason:\n";
+        uint64_t nodes = 0;
+        for (int reason = SearchTrace::Terminal; reason < SearchTrace::ReasonCount; ++reason)
+            nodes += summary.getReasonCount(reason);
+        for (int reason = SearchTrace::Terminal; reason < SearchTrace::ReasonCount; ++reason)
+        {
+            if (summary.getReasonCount(reason) != 0)
+                std::cout << "  " << std::setw(15) << std::left << TraceSummary::reasonName(reason) << std::right
+                          << std::setw(12) << summary.getReasonCount(reason) << std::setw(8)
+                          << percent(summary.getReasonCount(reason), nodes) << "%\n";
+        }
+
+        // Branching is over expanded nodes: legal moves, and children actually searched
+        std::cout << "By ply:\n"
+                  << "  ply        nodes   expanded  branching  searched  beta cut  first move  table cut\n";
+        const auto &plies = summary.getPlies();
+        for (size_t ply = 0; ply < plies.size(); ++ply)
+        {
+            const TraceSummary::PlyStats &stats = plies[ply];
+            if (stats.nodes == 0)
+                continue;
+            std::cout << "  " << std::setw(3) << ply << std::setw(13) << stats.nodes << std::setw(11) << stats.expanded
+                      << std::setw(11) << ratio(stats.legalMoves, stats.expanded) << std::setw(10)
+                      << ratio(stats.searchedMoves, stats.expanded) << std::setw(9)
+                      << percent(stats.betaCuts, stats.expanded) << "%" << std::setw(11)
+                      << percent(stats.firstMoveCuts, stats.betaCuts) << "%" << std::setw(10)
+                      << percent(stats.tableCuts, stats.nodes) << "%\n";
+        }
+
+        // Growth from one completed iteration to the next, averaged geometrically
+        double logGrowth = 0;
+        size_t steps = 0;
+        for (const TraceSummary::Run &run : runs)
+        {
+            for (size_t i = 1; i < run.iterationNodes.size(); ++i)
+            {
+                if (run.iterationNodes[i - 1] != 0 && run.iterationNodes[i] != 0)
+                {
+                    logGrowth += std::log(ratio(run.iterationNodes[i], run.iterationNodes[i - 1]));
+                    ++steps;
+                }
+            }
+        }
+        if (steps != 0)
+            std::cout << "Effective branching factor: " << std::exp(logGrowth / steps) << " over " << steps
+                      << " iterations\n";
+
+        std::cout << "Searches:\n";
+        for (const TraceSummary::Run &run : runs)
+        {
+            std::cout << "  writer " << run.writer << " run " << run.run << ": " << run.boardSize << "x"
+                      << run.boardSize << ", depth " << run.depth;
+            if (run.depthLimit > 0)
+                std::cout << "/" << run.depthLimit;
+            std::cout << ", score " << run.score << ", " << run.nodes << " nodes, " << run.micros / 1000.0 << " ms\n";
+        }
+
+        std::cout << "Hot subtrees:\n";
+        for (const TraceSummary::Subtree &subtree : summary.getHotSubtrees())
+        {
+            const TraceSummary::Run &run = runs[subtree.run];
+            std::cout << "  " << std::setw(12) << subtree.nodes << " nodes (" << percent(subtree.nodes, run.nodes)
+                      << "% of writer " << run.writer << " run " << run.run << ") ply " << subtree.ply << " depth "
+                      << subtree.depth << " " << TraceSummary::reasonName(subtree.reason) << " score "
+                      << subtree.score << ": " << TraceSummary::pathToString(subtree, run.boardSize) << "\n";
+        }
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
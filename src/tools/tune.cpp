@@ -0,0 +1,61 @@
+#include "objects/EvalTuner.h"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// Usage: tune <games per round> [rounds] [threads] [output header] [board sizes...]
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <games per round> [rounds] [threads] [output header] [board sizes...]\n";
+        return 1;
+    }
+
+    EvalTuner::Options options;
+    options.gamesPerRound = std::stoul(argv[1]);
+    options.rounds = argc > 2 ? std::stoi(argv[2]) : options.rounds;
+    options.threads = argc > 3 ? std::stoul(argv[3]) : std::thread::hardware_concurrency();
+    const std::string outputPath = argc > 4 ? argv[4] : "";
+    if (argc > 5)
+    {
+        options.boardSizes.clear();
+        for (int i = 5; i < argc; ++i)
+            options.boardSizes.push_back(std::stoul(argv[i]));
+    }
+
+    try
+    {
+        EvalTuner tuner(options);
+        const Evaluator::Weights weights = tuner.run(Evaluator::DefaultWeights, [](const EvalTuner::Round &round)
+                                                     {
+            std::cout << std::fixed << std::setprecision(4) << "round " << round.round << ": "
+                      << round.positions << " positions, mse " << round.meanSquaredError << ", "
+                      << std::setprecision(1) << round.seconds << "s, weights";
+            for (int weight : round.weights)
+                std::cout << " " << weight;
+            std::cout << std::endl; });
+
+        if (outputPath.empty())
+        {
+            EvalTuner::writeHeader(std::cout, weights);
+            return 0;
+        }
+        std::ofstream out(outputPath);
+        EvalTuner::writeHeader(out, weights);
+        if (!out)
+        {
+            std::cerr << "Failed to write " << outputPath << "\n";
+            return 1;
+        }
+        std::cout << "Weights written to " << outputPath << "\n";
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 1;
+    }
+    return 0;
+}